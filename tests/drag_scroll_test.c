@@ -0,0 +1,340 @@
+/**
+ * Copyright 2021 Charly Delay <charly@codesink.dev> (@0xcharly)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Feed synthetic trackball traces through drag-scroll.
+ *
+ * Built once with the default options, and once with the high-resolution
+ * scroll and the momentum of the Charybdis keymaps, see the `Makefile`.  Each
+ * trace is one sensor read per millisecond of a virtual clock, and this file
+ * implements the pointing device, the board and the deferred executors that
+ * `drag_scroll.c` relies on.
+ */
+
+#include <stdio.h>
+
+#include "drag_scroll.h"
+
+/** \brief Wheel units of a notch, the resolution that Windows and Linux ask for. */
+#define DRAG_SCROLL_TEST_HIRES_RESOLUTION 120
+
+/** \brief Idle time replayed after a trace, at most, to let the momentum stop. */
+#define DRAG_SCROLL_TEST_TAIL_MS 10000
+
+#define DRAG_SCROLL_TEST_DEFAULT_DPI 1000
+#define DRAG_SCROLL_TEST_SNIPING_DPI 200
+
+typedef struct {
+    int64_t  h;
+    int64_t  v;
+    uint32_t reports;
+    int32_t  max_report;
+} drag_scroll_test_output_t;
+
+typedef struct {
+    deferred_token         token;
+    uint32_t               trigger_time;
+    deferred_exec_callback callback;
+} drag_scroll_test_executor_t;
+
+static uint32_t                    drag_scroll_test_clock      = 0;
+static uint16_t                    drag_scroll_test_cpi        = DRAG_SCROLL_TEST_DEFAULT_DPI;
+static bool                        drag_scroll_test_sniping    = false;
+static report_mouse_t              drag_scroll_test_report     = {0};
+static drag_scroll_test_output_t   drag_scroll_test_output     = {0};
+static drag_scroll_test_executor_t drag_scroll_test_executors[4];
+static deferred_token              drag_scroll_test_last_token = INVALID_DEFERRED_TOKEN;
+static int                         drag_scroll_test_failures   = 0;
+
+#define DRAG_SCROLL_TEST_EXPECT(condition, ...)                \
+    do {                                                       \
+        if (!(condition)) {                                    \
+            fprintf(stderr, "%s:%d: ", __FILE__, __LINE__);    \
+            fprintf(stderr, __VA_ARGS__);                      \
+            fprintf(stderr, "\n");                             \
+            ++drag_scroll_test_failures;                       \
+        }                                                      \
+    } while (0)
+
+/* The parts of QMK and of the board used by `drag_scroll.c`. */
+
+uint16_t timer_read(void) {
+    return drag_scroll_test_clock;
+}
+
+uint32_t timer_read32(void) {
+    return drag_scroll_test_clock;
+}
+
+deferred_token defer_exec(uint32_t delay_ms, deferred_exec_callback callback, void *cb_arg) {
+    for (size_t i = 0; i < ARRAY_SIZE(drag_scroll_test_executors); ++i) {
+        if (drag_scroll_test_executors[i].token == INVALID_DEFERRED_TOKEN) {
+            drag_scroll_test_last_token   = drag_scroll_test_last_token % UINT8_MAX + 1;
+            drag_scroll_test_executors[i] = (drag_scroll_test_executor_t){drag_scroll_test_last_token, drag_scroll_test_clock + delay_ms, callback};
+            return drag_scroll_test_last_token;
+        }
+    }
+    return INVALID_DEFERRED_TOKEN;
+}
+
+static drag_scroll_test_executor_t *drag_scroll_test_executor(deferred_token token) {
+    for (size_t i = 0; i < ARRAY_SIZE(drag_scroll_test_executors); ++i) {
+        if (token != INVALID_DEFERRED_TOKEN && drag_scroll_test_executors[i].token == token) {
+            return &drag_scroll_test_executors[i];
+        }
+    }
+    return NULL;
+}
+
+bool extend_deferred_exec(deferred_token token, uint32_t delay_ms) {
+    drag_scroll_test_executor_t *executor = drag_scroll_test_executor(token);
+    if (executor == NULL) {
+        return false;
+    }
+    executor->trigger_time = drag_scroll_test_clock + delay_ms;
+    return true;
+}
+
+bool cancel_deferred_exec(deferred_token token) {
+    drag_scroll_test_executor_t *executor = drag_scroll_test_executor(token);
+    if (executor == NULL) {
+        return false;
+    }
+    executor->token = INVALID_DEFERRED_TOKEN;
+    return true;
+}
+
+report_mouse_t pointing_device_get_report(void) {
+    return drag_scroll_test_report;
+}
+
+void pointing_device_set_report(report_mouse_t mouse_report) {
+    drag_scroll_test_report = mouse_report;
+}
+
+static void drag_scroll_test_record(const report_mouse_t *mouse_report) {
+    if (mouse_report->h == 0 && mouse_report->v == 0) {
+        return;
+    }
+    drag_scroll_test_output.h += mouse_report->h;
+    drag_scroll_test_output.v += mouse_report->v;
+    drag_scroll_test_output.max_report = MAX(drag_scroll_test_output.max_report, MAX(abs(mouse_report->h), abs(mouse_report->v)));
+    ++drag_scroll_test_output.reports;
+}
+
+bool pointing_device_send(void) {
+    drag_scroll_test_record(&drag_scroll_test_report);
+    drag_scroll_test_report = (report_mouse_t){0};
+    return true;
+}
+
+uint16_t pointing_device_get_cpi(void) {
+    return drag_scroll_test_cpi;
+}
+
+void pointing_device_set_cpi(uint16_t cpi) {
+    drag_scroll_test_cpi = cpi;
+}
+
+#ifdef POINTING_DEVICE_HIRES_SCROLL_ENABLE
+uint16_t pointing_device_get_hires_scroll_resolution(void) {
+    return DRAG_SCROLL_TEST_HIRES_RESOLUTION;
+}
+#    define DRAG_SCROLL_TEST_RESOLUTION DRAG_SCROLL_TEST_HIRES_RESOLUTION
+#else
+#    define DRAG_SCROLL_TEST_RESOLUTION 1
+#endif // POINTING_DEVICE_HIRES_SCROLL_ENABLE
+
+uint16_t dilemma_get_pointer_default_dpi(void) {
+    return DRAG_SCROLL_TEST_DEFAULT_DPI;
+}
+
+uint16_t dilemma_get_pointer_sniping_dpi(void) {
+    return DRAG_SCROLL_TEST_SNIPING_DPI;
+}
+
+bool dilemma_get_pointer_sniping_enabled(void) {
+    return drag_scroll_test_sniping;
+}
+
+/* Driver. */
+
+typedef void (*drag_scroll_test_trace_t)(uint32_t read, int16_t *x, int16_t *y);
+
+static bool drag_scroll_test_key(uint16_t keycode, bool pressed) {
+    keyrecord_t record = {.event = {.key = {.col = 0, .row = 0}, .time = timer_read(), .type = KEY_EVENT, .pressed = pressed}};
+    return drag_scroll_process_record(keycode, &record);
+}
+
+/** \brief One millisecond: the due deferred executors, then a sensor read through the pointing task. */
+static void drag_scroll_test_tick(int16_t x, int16_t y) {
+    for (size_t i = 0; i < ARRAY_SIZE(drag_scroll_test_executors); ++i) {
+        drag_scroll_test_executor_t *executor = &drag_scroll_test_executors[i];
+        if (executor->token != INVALID_DEFERRED_TOKEN && executor->trigger_time <= drag_scroll_test_clock) {
+            uint32_t delay = executor->callback(executor->trigger_time, NULL);
+            if (delay == 0) {
+                executor->token = INVALID_DEFERRED_TOKEN;
+            } else {
+                executor->trigger_time += delay;
+            }
+        }
+    }
+    report_mouse_t mouse_report = {.x = x, .y = y};
+    if (drag_scroll_task(&mouse_report)) {
+        drag_scroll_test_record(&mouse_report);
+    }
+    ++drag_scroll_test_clock;
+}
+
+static bool drag_scroll_test_idle(void) {
+    for (size_t i = 0; i < ARRAY_SIZE(drag_scroll_test_executors); ++i) {
+        if (drag_scroll_test_executors[i].token != INVALID_DEFERRED_TOKEN) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** \brief Replay `reads` sensor reads of a trace with drag-scroll held. */
+static drag_scroll_test_output_t drag_scroll_test_run(drag_scroll_test_trace_t trace, uint32_t reads) {
+    drag_scroll_test_output = (drag_scroll_test_output_t){0};
+    drag_scroll_test_key(DRAGSCROLL_MODE, true);
+    for (uint32_t read = 0; read < reads; ++read) {
+        int16_t x = 0, y = 0;
+        trace(read, &x, &y);
+        drag_scroll_test_tick(x, y);
+    }
+    drag_scroll_test_key(DRAGSCROLL_MODE, false);
+    return drag_scroll_test_output;
+}
+
+/** \brief Let the momentum of the previous trace run out, and return what it scrolled. */
+static drag_scroll_test_output_t drag_scroll_test_coast(void) {
+    drag_scroll_test_output = (drag_scroll_test_output_t){0};
+    for (uint32_t tail = 0; tail < DRAG_SCROLL_TEST_TAIL_MS && !drag_scroll_test_idle(); ++tail) {
+        drag_scroll_test_tick(0, 0);
+    }
+    return drag_scroll_test_output;
+}
+
+/** \brief Units of `counts` trackball counts, in a single direction. */
+static int64_t drag_scroll_test_expected(int64_t counts) {
+    return counts * DRAG_SCROLL_TEST_RESOLUTION / VENDOR_DRAG_SCROLL_COUNTS_PER_NOTCH;
+}
+
+/* Traces. */
+
+/** \brief Slow diagonal move, 1 count per read, down and to the right. */
+static void drag_scroll_test_slow(uint32_t read, int16_t *x, int16_t *y) {
+    *x = 1;
+    *y = 1;
+}
+
+/** \brief Back and forth, less than a notch each way. */
+static void drag_scroll_test_swing(uint32_t read, int16_t *x, int16_t *y) {
+    *x = 0;
+    *y = read % 2 ? -(VENDOR_DRAG_SCROLL_COUNTS_PER_NOTCH - 1) : VENDOR_DRAG_SCROLL_COUNTS_PER_NOTCH - 1;
+}
+
+/** \brief Fast flick up, a notch per read. */
+static void drag_scroll_test_flick(uint32_t read, int16_t *x, int16_t *y) {
+    *x = 0;
+    *y = -VENDOR_DRAG_SCROLL_COUNTS_PER_NOTCH;
+}
+
+/* Tests. */
+
+/** \brief The sensor is at the drag-scroll DPI while drag-scroll is on, then at the board DPI of the moment. */
+static void drag_scroll_test_cpi_restore(void) {
+    DRAG_SCROLL_TEST_EXPECT(drag_scroll_test_key(KC_A, true), "KC_A taken over");
+
+    DRAG_SCROLL_TEST_EXPECT(!drag_scroll_test_key(DRAGSCROLL_MODE, true), "DRAGSCROLL_MODE not taken over");
+    DRAG_SCROLL_TEST_EXPECT(drag_scroll_test_cpi == VENDOR_DRAG_SCROLL_DPI, "CPI %u while drag-scrolling", drag_scroll_test_cpi);
+    // Eg. auto-sniping, while drag-scroll is held.
+    drag_scroll_test_sniping = true;
+    drag_scroll_test_key(DRAGSCROLL_MODE, false);
+    DRAG_SCROLL_TEST_EXPECT(drag_scroll_test_cpi == DRAG_SCROLL_TEST_SNIPING_DPI, "CPI %u after drag-scroll while sniping", drag_scroll_test_cpi);
+
+    drag_scroll_test_key(DRAGSCROLL_TOGGLE, true);
+    drag_scroll_test_key(DRAGSCROLL_TOGGLE, false);
+    DRAG_SCROLL_TEST_EXPECT(drag_scroll_test_cpi == VENDOR_DRAG_SCROLL_DPI, "CPI %u while drag-scroll is toggled on", drag_scroll_test_cpi);
+    drag_scroll_test_sniping = false;
+    drag_scroll_test_key(DRAGSCROLL_TOGGLE, true);
+    drag_scroll_test_key(DRAGSCROLL_TOGGLE, false);
+    DRAG_SCROLL_TEST_EXPECT(drag_scroll_test_cpi == DRAG_SCROLL_TEST_DEFAULT_DPI, "CPI %u after drag-scroll", drag_scroll_test_cpi);
+}
+
+/** \brief Every count is scrolled, remainders included, in the direction of the trackball. */
+static void drag_scroll_test_conservation(void) {
+    const uint32_t                  reads  = 60 * VENDOR_DRAG_SCROLL_COUNTS_PER_NOTCH;
+    const drag_scroll_test_output_t output = drag_scroll_test_run(drag_scroll_test_slow, reads);
+    const int64_t                   units  = drag_scroll_test_expected(reads);
+#ifdef VENDOR_DRAG_SCROLL_REVERSE_Y
+    const int64_t v = -units;
+#else
+    const int64_t v = units;
+#endif // VENDOR_DRAG_SCROLL_REVERSE_Y
+    DRAG_SCROLL_TEST_EXPECT(output.h == units && output.v == v, "scrolled (%lld, %lld), expected (%lld, %lld)", (long long)output.h, (long long)output.v, (long long)units, (long long)v);
+#ifdef POINTING_DEVICE_HIRES_SCROLL_ENABLE
+    // Fractions of a notch, at every read, instead of a notch now and then.
+    DRAG_SCROLL_TEST_EXPECT(output.reports == reads, "%u reports for %u reads", output.reports, reads);
+    DRAG_SCROLL_TEST_EXPECT(output.max_report < DRAG_SCROLL_TEST_RESOLUTION, "report of %d units", output.max_report);
+#else
+    DRAG_SCROLL_TEST_EXPECT(output.reports == reads / VENDOR_DRAG_SCROLL_COUNTS_PER_NOTCH, "%u reports for %u reads", output.reports, reads);
+#endif // POINTING_DEVICE_HIRES_SCROLL_ENABLE
+    drag_scroll_test_coast();
+}
+
+/** \brief Reversing drops the remainder, so small back and forth moves do not add up. */
+static void drag_scroll_test_reversal(void) {
+    const drag_scroll_test_output_t output = drag_scroll_test_run(drag_scroll_test_swing, 100);
+#ifndef POINTING_DEVICE_HIRES_SCROLL_ENABLE
+    DRAG_SCROLL_TEST_EXPECT(output.reports == 0, "%u reports for moves under a notch", output.reports);
+#endif // POINTING_DEVICE_HIRES_SCROLL_ENABLE
+    DRAG_SCROLL_TEST_EXPECT(output.v == 0, "scrolled %lld after full swings", (long long)output.v);
+    drag_scroll_test_coast();
+}
+
+/** \brief After a flick, scrolling goes on in the same direction, slowing down, until the trackball moves again. */
+static void drag_scroll_test_momentum(void) {
+    const drag_scroll_test_output_t flick = drag_scroll_test_run(drag_scroll_test_flick, 100);
+    const drag_scroll_test_output_t coast = drag_scroll_test_coast();
+    DRAG_SCROLL_TEST_EXPECT(llabs(flick.v) == drag_scroll_test_expected(100 * VENDOR_DRAG_SCROLL_COUNTS_PER_NOTCH), "flick of %lld", (long long)flick.v);
+#ifdef VENDOR_DRAG_SCROLL_MOMENTUM_ENABLE
+    DRAG_SCROLL_TEST_EXPECT(coast.reports > 0 && (coast.v < 0) == (flick.v < 0) && coast.h == 0, "coasted (%lld, %lld) in %u reports after a flick of %lld", (long long)coast.h, (long long)coast.v, coast.reports, (long long)flick.v);
+    // At most the speed of the flick, decaying at each tick.
+    const int64_t coast_max = llabs(flick.v) / 100 * VENDOR_DRAG_SCROLL_MOMENTUM_TICK_MS * 256 / (256 - VENDOR_DRAG_SCROLL_MOMENTUM_DECAY);
+    DRAG_SCROLL_TEST_EXPECT(llabs(coast.v) <= coast_max, "coasted %lld after a flick of %lld, expected at most %lld", (long long)coast.v, (long long)flick.v, (long long)coast_max);
+    DRAG_SCROLL_TEST_EXPECT(drag_scroll_test_idle(), "still coasting after %u ms", DRAG_SCROLL_TEST_TAIL_MS);
+
+    // Moving the pointer stops the momentum.
+    drag_scroll_test_run(drag_scroll_test_flick, 100);
+    drag_scroll_test_output = (drag_scroll_test_output_t){0};
+    drag_scroll_test_tick(1, 1);
+    DRAG_SCROLL_TEST_EXPECT(drag_scroll_test_coast().reports == 0, "coasting after the pointer moved");
+#else
+    DRAG_SCROLL_TEST_EXPECT(coast.reports == 0, "%u reports after the trackball stopped", coast.reports);
+#endif // VENDOR_DRAG_SCROLL_MOMENTUM_ENABLE
+}
+
+int main(void) {
+    drag_scroll_test_cpi_restore();
+    drag_scroll_test_conservation();
+    drag_scroll_test_reversal();
+    drag_scroll_test_momentum();
+    return drag_scroll_test_failures ? 1 : 0;
+}
@@ -0,0 +1,152 @@
+#!/usr/bin/env python3
+# Copyright 2021 Charly Delay <charly@codesink.dev> (@0xcharly)
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+"""Read the instrumentation of the replay harness with the host reader.
+
+Usage: instrumentation_test.py REPLAY TRACE...
+
+REPLAY is the replay harness built with `VENDOR_INSTRUMENTATION_ENABLE`.  Each
+trace is replayed twice: once to log what the keymap does, and once with
+`--raw-hid`, to read the instrumentation through `Reader` of
+`users/vendor/instrumentation_reader.py`, as from a keyboard.  What the reader
+decodes must match the log.  On the host, a tick is a millisecond.
+"""
+
+import os
+import re
+import subprocess
+import sys
+
+# Leave no bytecode next to the reader.
+sys.dont_write_bytecode = True
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "users", "vendor"))
+
+from instrumentation_reader import EVENTS, HISTOGRAMS, PROTOCOL_VERSION, Reader  # noqa: E402
+
+PROCESS = re.compile(r"^\s*(\d+) process  r\d+ c\d+\s+down kc ([0-9A-F]{4}) tap \d+ delay (\d+)$")
+REPORT = re.compile(r"^\s*(\d+) report ")
+LOG_TIME = re.compile(r"^\s*(\d+) ")
+
+
+class ReplayDevice:
+    """The replay harness, answering raw HID packets once the trace is replayed."""
+
+    def __init__(self, replay, trace):
+        self._process = subprocess.Popen([replay, "--raw-hid", trace], stdin=subprocess.PIPE, stdout=subprocess.PIPE, text=True)
+
+    def transact(self, packet):
+        self._process.stdin.write(packet.hex() + "\n")
+        self._process.stdin.flush()
+        return bytes.fromhex(self._process.stdout.readline().strip())
+
+    def close(self):
+        self._process.stdin.close()
+        return self._process.wait()
+
+
+def bucket(us, bucket_count):
+    """Histogram bucket of a duration, as `instrumentation_histogram_add`."""
+    return min(us.bit_length(), bucket_count - 1)
+
+
+def expected(log, bucket_count):
+    """Events and histograms that the instrumentation must have recorded during the replay."""
+    events = {name: [] for name in EVENTS.values()}
+    histograms = {name: [0] * bucket_count for name in ("process", "report")}
+    pending_press = None
+    last_time = 0
+    for line in log.splitlines():
+        time = LOG_TIME.match(line)
+        if time:
+            last_time = int(time.group(1))
+        process = PROCESS.match(line)
+        report = REPORT.match(line)
+        if process:
+            time, keycode, delay = int(process.group(1)), int(process.group(2), 16), int(process.group(3))
+            events["press"].append((keycode, time - delay))
+            events["process"].append((keycode, time))
+            histograms["process"][bucket(delay * 1000, bucket_count)] += 1
+            if pending_press is None:
+                pending_press = time - delay
+        elif report:
+            time = int(report.group(1))
+            events["report"].append((0, time))
+            if pending_press is not None:
+                histograms["report"][bucket((time - pending_press) * 1000, bucket_count)] += 1
+                pending_press = None
+    return events, histograms, last_time
+
+
+def check(replay, trace):
+    failures = []
+
+    def expect(condition, message, *args):
+        if not condition:
+            failures.append(message % args)
+
+    log = subprocess.run([replay, trace], stdout=subprocess.PIPE, text=True, check=True).stdout
+    device = ReplayDevice(replay, trace)
+    reader = Reader(device)
+    info = reader.info()
+    histograms = {HISTOGRAMS[index]: reader.histogram(index, info["buckets"]) for index in range(info["histograms"])}
+    events = {name: [] for name in EVENTS.values()}
+    for event_type, keycode, tick in reader.events():
+        events[EVENTS[event_type]].append((keycode, tick))
+    drained = next(reader.events(), None)
+    reader.reset()
+    after_reset = reader.info()
+    histograms_after_reset = [reader.histogram(index, info["buckets"]) for index in range(info["histograms"])]
+    expect(device.close() == 0, "replay --raw-hid failed")
+
+    expected_events, expected_histograms, last_time = expected(log, info["buckets"])
+
+    expect(info["version"] == PROTOCOL_VERSION, "protocol version %d", info["version"])
+    expect(info["ticks_per_ms"] == 1, "%d ticks per ms", info["ticks_per_ms"])
+    expect(info["histograms"] == len(HISTOGRAMS), "%d histograms", info["histograms"])
+    expect(info["dropped"] == 0, "%d dropped events", info["dropped"])
+    if last_time >= 1000:
+        expect(info["scan_rate"] == 1000, "%d scans per second, one scan per ms", info["scan_rate"])
+
+    # One scan per millisecond: every interval lands in the bucket of 1000us.
+    scans = histograms["scan"]
+    expect(scans[bucket(1000, info["buckets"])] == sum(scans) and sum(scans) >= last_time, "scan histogram %s", scans)
+    for name in ("press", "process", "report"):
+        expect(events[name] == expected_events[name], "%s events %s, expected %s", name, events[name], expected_events[name])
+    for name in ("process", "report"):
+        expect(histograms[name] == expected_histograms[name], "%s histogram %s, expected %s", name, histograms[name], expected_histograms[name])
+    expect(len(events["tap_dance"]) == sum(histograms["tap_dance"]), "%d tap dance events, %d in the histogram", len(events["tap_dance"]), sum(histograms["tap_dance"]))
+    expect(sum(histograms["pointing"]) == 0, "pointing histogram %s without a pointing device", histograms["pointing"])
+    expect(drained is None, "events left after draining")
+    expect(after_reset["dropped"] == 0 and not any(map(any, histograms_after_reset)), "histograms left after a reset")
+    return failures
+
+
+def main():
+    if len(sys.argv) < 3:
+        print(__doc__, file=sys.stderr)
+        return 2
+    status = 0
+    for trace in sys.argv[2:]:
+        name = os.path.splitext(os.path.basename(trace))[0]
+        failures = check(sys.argv[1], trace)
+        print("%s instrumentation %s" % ("FAIL" if failures else "PASS", name))
+        for failure in failures:
+            print("  " + failure)
+        status |= bool(failures)
+    return status
+
+
+if __name__ == "__main__":
+    sys.exit(main())
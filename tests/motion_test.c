@@ -0,0 +1,180 @@
+/**
+ * Copyright 2021 Charly Delay <charly@codesink.dev> (@0xcharly)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Feed synthetic sensor traces through the trackball motion pipeline.
+ *
+ * Built with the userspace `config.h` of a pointing board, once with the
+ * default options and once with an acceleration curve and a 125Hz host, see
+ * the `Makefile`.  Each trace is one sensor read per millisecond, and the
+ * reports are checked against the motion expected from the curve.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifndef VENDOR_MOTION_CURVE
+#    define MOTION_TEST_DEFAULT_CURVE
+#endif // VENDOR_MOTION_CURVE
+
+#include "motion.h"
+
+/** \brief Reads fed after the end of a trace, at most, to flush the pending motion. */
+#define MOTION_TEST_FLUSH_READS 1000
+
+typedef struct {
+    int64_t  x;
+    int64_t  y;
+    uint32_t reports;
+    uint32_t min_interval;
+    int32_t  max_report;
+} motion_test_output_t;
+
+typedef void (*motion_test_trace_t)(uint32_t read, int16_t *x, int16_t *y);
+
+static int motion_test_failures = 0;
+
+#define MOTION_TEST_EXPECT(condition, ...)                     \
+    do {                                                       \
+        if (!(condition)) {                                    \
+            fprintf(stderr, "%s:%d: ", __FILE__, __LINE__);    \
+            fprintf(stderr, __VA_ARGS__);                      \
+            fprintf(stderr, "\n");                             \
+            ++motion_test_failures;                            \
+        }                                                      \
+    } while (0)
+
+/** \brief Replay `reads` sensor reads of a trace, and flush the motion left. */
+static motion_test_output_t motion_test_run(motion_test_trace_t trace, uint32_t reads) {
+    motion_state_t       state       = {0};
+    motion_test_output_t output      = {.min_interval = UINT32_MAX};
+    uint32_t             last_report = 0;
+
+    for (uint32_t read = 0; read < reads + MOTION_TEST_FLUSH_READS; ++read) {
+        int16_t x = 0, y = 0;
+        if (read < reads) {
+            trace(read, &x, &y);
+            motion_accelerate(&state, &x, &y);
+        } else if (!state.pending_x && !state.pending_y) {
+            break;
+        }
+        // Reads start at 1ms, so that the first one can be reported.
+        motion_coalesce(&state, &x, &y, read + 1);
+        if (x || y) {
+            if (output.reports && read + 1 - last_report < output.min_interval) {
+                output.min_interval = read + 1 - last_report;
+            }
+            if (abs(x) > output.max_report || abs(y) > output.max_report) {
+                output.max_report = abs(x) > abs(y) ? abs(x) : abs(y);
+            }
+            last_report = read + 1;
+            output.x += x;
+            output.y += y;
+            ++output.reports;
+        }
+    }
+    return output;
+}
+
+/** \brief Counts expected from `reads` reads of `value` counts at a constant gain. */
+static int64_t motion_test_expected(uint32_t reads, int16_t value, uint16_t gain) {
+    return (int64_t)reads * value * gain / 256;
+}
+
+static int16_t motion_test_speed;
+
+static void motion_test_constant(uint32_t read, int16_t *x, int16_t *y) {
+    *x = motion_test_speed;
+    *y = -motion_test_speed / 2;
+}
+
+static void motion_test_saturated(uint32_t read, int16_t *x, int16_t *y) {
+    *x = 127;
+    *y = 127;
+}
+
+/** \brief Sub-count motion while sniping: 1 count every other read. */
+static void motion_test_sniping(uint32_t read, int16_t *x, int16_t *y) {
+    *x = read % 2;
+    *y = -(read % 2);
+}
+
+/** \brief Flick back and forth, a full swing every 200 reads. */
+static void motion_test_swing(uint32_t read, int16_t *x, int16_t *y) {
+    *x = read % 200 < 100 ? 6 : -6;
+    *y = 0;
+}
+
+/** \brief The motion of each read is reported, scaled by the gain of its speed, to the count. */
+static void motion_test_conservation(void) {
+    for (motion_test_speed = 2; motion_test_speed <= 64; motion_test_speed += 2) {
+        const uint16_t             gain   = motion_gain(motion_test_speed + motion_test_speed / 2 / 2);
+        const motion_test_output_t output = motion_test_run(motion_test_constant, 1000);
+        const int64_t              x      = motion_test_expected(1000, motion_test_speed, gain);
+        const int64_t              y      = motion_test_expected(1000, -motion_test_speed / 2, gain);
+        MOTION_TEST_EXPECT(output.x == x && output.y == y, "speed %d: reported (%lld, %lld), expected (%lld, %lld)", motion_test_speed, (long long)output.x, (long long)output.y, (long long)x, (long long)y);
+    }
+}
+
+/** \brief Moves beyond the 8-bit report range are not clamped. */
+static void motion_test_saturation(void) {
+    const uint16_t             gain   = motion_gain(127 + 127 / 2);
+    const motion_test_output_t output = motion_test_run(motion_test_saturated, 100);
+    const int64_t              counts = motion_test_expected(100, 127, gain);
+    MOTION_TEST_EXPECT(output.x == counts && output.y == counts, "reported (%lld, %lld), expected %lld", (long long)output.x, (long long)output.y, (long long)counts);
+}
+
+/** \brief Fractions of a count add up across reads instead of being lost. */
+static void motion_test_sub_count(void) {
+    const motion_test_output_t output = motion_test_run(motion_test_sniping, 1000);
+    const int64_t              counts = motion_test_expected(500, 1, motion_gain(1));
+    MOTION_TEST_EXPECT(output.x == counts && output.y == -counts, "reported (%lld, %lld), expected %lld", (long long)output.x, (long long)output.y, (long long)counts);
+}
+
+/** \brief Reversing drops the remainder, so the pointer comes back where it started. */
+static void motion_test_reversal(void) {
+    const motion_test_output_t output = motion_test_run(motion_test_swing, 1000);
+    MOTION_TEST_EXPECT(output.x == 0 && output.y == 0, "reported (%lld, %lld) after full swings", (long long)output.x, (long long)output.y);
+}
+
+/** \brief Reports are spaced by at least the host polling interval. */
+static void motion_test_coalescing(void) {
+    motion_test_speed                 = 10;
+    const motion_test_output_t output = motion_test_run(motion_test_constant, 1000);
+    MOTION_TEST_EXPECT(output.min_interval >= VENDOR_MOTION_REPORT_INTERVAL_MS, "reports %u ms apart", output.min_interval);
+    MOTION_TEST_EXPECT(output.reports <= 1000 / VENDOR_MOTION_REPORT_INTERVAL_MS + 1, "%u reports for 1000 reads", output.reports);
+    MOTION_TEST_EXPECT(output.max_report <= VENDOR_MOTION_REPORT_MAX, "report of %d counts", output.max_report);
+}
+
+/** \brief Without a curve from the keymap, the motion is not scaled. */
+static void motion_test_default_curve(void) {
+#ifdef MOTION_TEST_DEFAULT_CURVE
+    for (uint16_t speed = 0; speed < 512; ++speed) {
+        MOTION_TEST_EXPECT(motion_gain(speed) == 256, "gain %u at speed %u", motion_gain(speed), speed);
+    }
+#endif // MOTION_TEST_DEFAULT_CURVE
+}
+
+int main(void) {
+    motion_test_conservation();
+    motion_test_saturation();
+    motion_test_sub_count();
+    motion_test_reversal();
+    motion_test_coalescing();
+    motion_test_default_curve();
+    return motion_test_failures ? 1 : 0;
+}
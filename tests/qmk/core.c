@@ -0,0 +1,865 @@
+/**
+ * Copyright 2021 Charly Delay <charly@codesink.dev> (@0xcharly)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Stubbed QMK core.
+ *
+ * Follows the code paths of QMK that the `vendor` keymaps rely on: the
+ * tapping state machine of `action_tapping.c` (mod-taps and layer-taps, with
+ * `PERMISSIVE_HOLD` and per-key tapping terms), `process_tap_dance.c`, the
+ * deferred executors, the keyboard report and its deduplication, and the
+ * layer stack.  Quick-tap (auto-repeat of a double-tapped mod-tap), one-shot
+ * keys, mouse keys and lighting are not modelled.
+ */
+
+#include <string.h>
+
+#include "harness.h"
+#include "host.h"
+
+#ifndef WAITING_BUFFER_SIZE
+#    define WAITING_BUFFER_SIZE 8
+#endif // WAITING_BUFFER_SIZE
+
+#ifndef MAX_DEFERRED_EXECUTORS
+#    define MAX_DEFERRED_EXECUTORS 8
+#endif // MAX_DEFERRED_EXECUTORS
+
+FILE *harness_log = NULL;
+
+static harness_stats_t harness_statistics;
+static uint32_t        harness_clock           = 0;
+static bool            harness_scan_has_events = false;
+static bool            harness_report_pending  = false;
+static uint16_t        harness_report_press    = 0;
+
+/* Timer. */
+
+uint16_t timer_read(void) {
+    return harness_clock;
+}
+
+uint32_t timer_read32(void) {
+    return harness_clock;
+}
+
+uint16_t timer_elapsed(uint16_t last) {
+    return TIMER_DIFF_16(timer_read(), last);
+}
+
+uint32_t timer_elapsed32(uint32_t last) {
+    return TIMER_DIFF_32(timer_read32(), last);
+}
+
+/** Blocks the firmware: time passes without scanning. */
+void wait_ms(uint32_t ms) {
+    harness_clock += ms;
+}
+
+/* Host. */
+
+static void harness_log_keyboard(report_keyboard_t *report) {
+    fprintf(harness_log, "%6u report   mods %02X keys", harness_clock, report->mods);
+    bool empty = true;
+    for (uint8_t i = 0; i < ARRAY_SIZE(report->keys); ++i) {
+        if (report->keys[i]) {
+            fprintf(harness_log, " %02X", report->keys[i]);
+            empty = false;
+        }
+    }
+    fprintf(harness_log, "%s\n", empty ? " -" : "");
+}
+
+/** Record the latency of the oldest press not reported yet, like `instrumentation.c`. */
+static void harness_record_report(void) {
+    ++harness_statistics.reports;
+    if (!harness_report_pending) {
+        return;
+    }
+    uint32_t delay                          = TIMER_DIFF_16(timer_read(), harness_report_press);
+    harness_statistics.report_delay_max     = MAX(harness_statistics.report_delay_max, delay);
+    harness_statistics.report_delay_sum    += delay;
+    harness_statistics.report_delay_count  += 1;
+    harness_report_pending                  = false;
+}
+
+static void harness_send_keyboard(report_keyboard_t *report) {
+    if (harness_log != NULL) {
+        harness_log_keyboard(report);
+    }
+    harness_record_report();
+}
+
+static void harness_send_nkro(report_nkro_t *report) {}
+
+static void harness_send_mouse(report_mouse_t *report) {}
+
+static void harness_send_extra(report_extra_t *report) {
+    if (harness_log != NULL) {
+        fprintf(harness_log, "%6u consumer %04X\n", harness_clock, report->usage);
+    }
+    harness_record_report();
+}
+
+static host_driver_t  harness_driver = {NULL, harness_send_keyboard, harness_send_nkro, harness_send_mouse, harness_send_extra};
+static host_driver_t *host_driver    = &harness_driver;
+
+host_driver_t *host_get_driver(void) {
+    return host_driver;
+}
+
+void host_set_driver(host_driver_t *driver) {
+    host_driver = driver;
+}
+
+void host_keyboard_send(report_keyboard_t *report) {
+    host_driver->send_keyboard(report);
+}
+
+void host_consumer_send(uint16_t usage) {
+    static uint16_t last_usage = 0;
+    if (usage == last_usage) {
+        return;
+    }
+    last_usage            = usage;
+    report_extra_t report = {.report_id = 3, .usage = usage};
+    host_driver->send_extra(&report);
+}
+
+/* Keyboard report. */
+
+static report_keyboard_t keyboard_report;
+static report_keyboard_t last_keyboard_report;
+static uint8_t           real_mods = 0;
+static uint8_t           weak_mods = 0;
+
+void add_key(uint8_t key) {
+    int8_t empty = -1;
+    for (uint8_t i = 0; i < ARRAY_SIZE(keyboard_report.keys); ++i) {
+        if (keyboard_report.keys[i] == key) {
+            return;
+        }
+        if (empty == -1 && keyboard_report.keys[i] == 0) {
+            empty = i;
+        }
+    }
+    if (empty != -1) {
+        keyboard_report.keys[empty] = key;
+    }
+}
+
+void del_key(uint8_t key) {
+    for (uint8_t i = 0; i < ARRAY_SIZE(keyboard_report.keys); ++i) {
+        if (keyboard_report.keys[i] == key) {
+            keyboard_report.keys[i] = 0;
+        }
+    }
+}
+
+void clear_keys(void) {
+    memset(keyboard_report.keys, 0, sizeof(keyboard_report.keys));
+}
+
+static bool is_key_pressed(uint8_t key) {
+    for (uint8_t i = 0; i < ARRAY_SIZE(keyboard_report.keys); ++i) {
+        if (keyboard_report.keys[i] == key) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint8_t get_mods(void) {
+    return real_mods;
+}
+
+void add_mods(uint8_t mods) {
+    real_mods |= mods;
+}
+
+void del_mods(uint8_t mods) {
+    real_mods &= ~mods;
+}
+
+void clear_mods(void) {
+    real_mods = 0;
+}
+
+uint8_t get_weak_mods(void) {
+    return weak_mods;
+}
+
+void add_weak_mods(uint8_t mods) {
+    weak_mods |= mods;
+}
+
+void del_weak_mods(uint8_t mods) {
+    weak_mods &= ~mods;
+}
+
+void clear_weak_mods(void) {
+    weak_mods = 0;
+}
+
+/** Only sends the report if it changed, like QMK. */
+void send_keyboard_report(void) {
+    keyboard_report.mods = real_mods | weak_mods;
+    if (memcmp(&keyboard_report, &last_keyboard_report, sizeof(keyboard_report)) == 0) {
+        return;
+    }
+    last_keyboard_report = keyboard_report;
+    host_keyboard_send(&keyboard_report);
+}
+
+/** \brief HID usage of a consumer keycode. */
+static uint16_t keycode_to_consumer(uint8_t code) {
+    switch (code) {
+        case KC_AUDIO_MUTE:
+            return 0x00E2;
+        case KC_AUDIO_VOL_UP:
+            return 0x00E9;
+        case KC_AUDIO_VOL_DOWN:
+            return 0x00EA;
+        case KC_MEDIA_NEXT_TRACK:
+            return 0x00B5;
+        case KC_MEDIA_PREV_TRACK:
+            return 0x00B6;
+        case KC_MEDIA_STOP:
+            return 0x00B7;
+        case KC_MEDIA_PLAY_PAUSE:
+            return 0x00CD;
+        default:
+            return 0;
+    }
+}
+
+/** \brief 8-bit modifier mask of the 5-bit mask of a keycode. */
+static uint8_t mod_config(uint8_t mods) {
+    return (mods & 0x10) ? (mods & 0x0F) << 4 : mods & 0x0F;
+}
+
+void register_code(uint8_t code) {
+    if (IS_BASIC_KEYCODE(code)) {
+        // Force a new key press if the key is already pressed.
+        if (is_key_pressed(code)) {
+            del_key(code);
+            send_keyboard_report();
+        }
+        add_key(code);
+        send_keyboard_report();
+    } else if (IS_MODIFIER_KEYCODE(code)) {
+        add_mods(MOD_BIT(code));
+        send_keyboard_report();
+    } else if (IS_CONSUMER_KEYCODE(code)) {
+        host_consumer_send(keycode_to_consumer(code));
+    }
+}
+
+void unregister_code(uint8_t code) {
+    if (IS_BASIC_KEYCODE(code)) {
+        del_key(code);
+        send_keyboard_report();
+    } else if (IS_MODIFIER_KEYCODE(code)) {
+        del_mods(MOD_BIT(code));
+        send_keyboard_report();
+    } else if (IS_CONSUMER_KEYCODE(code)) {
+        host_consumer_send(0);
+    }
+}
+
+void tap_code(uint8_t code) {
+    register_code(code);
+    wait_ms(TAP_CODE_DELAY);
+    unregister_code(code);
+}
+
+void register_mods(uint8_t mods) {
+    if (mods) {
+        add_mods(mods);
+        send_keyboard_report();
+    }
+}
+
+void unregister_mods(uint8_t mods) {
+    if (mods) {
+        del_mods(mods);
+        send_keyboard_report();
+    }
+}
+
+static void register_weak_mods(uint8_t mods) {
+    if (mods) {
+        add_weak_mods(mods);
+        send_keyboard_report();
+    }
+}
+
+static void unregister_weak_mods(uint8_t mods) {
+    if (mods) {
+        del_weak_mods(mods);
+        send_keyboard_report();
+    }
+}
+
+void register_code16(uint16_t code) {
+    uint8_t mods = mod_config(QK_MODS_GET_MODS(code));
+    if (IS_MODIFIER_KEYCODE(code & 0xFF) || (code & 0xFF) == KC_NO) {
+        register_mods(mods);
+    } else {
+        register_weak_mods(mods);
+    }
+    register_code(code & 0xFF);
+}
+
+void unregister_code16(uint16_t code) {
+    uint8_t mods = mod_config(QK_MODS_GET_MODS(code));
+    unregister_code(code & 0xFF);
+    if (IS_MODIFIER_KEYCODE(code & 0xFF) || (code & 0xFF) == KC_NO) {
+        unregister_mods(mods);
+    } else {
+        unregister_weak_mods(mods);
+    }
+}
+
+void tap_code16(uint16_t code) {
+    register_code16(code);
+    wait_ms(TAP_CODE_DELAY);
+    unregister_code16(code);
+}
+
+/* Layers. */
+
+layer_state_t layer_state         = 0;
+layer_state_t default_layer_state = 1;
+
+__attribute__((weak)) layer_state_t layer_state_set_user(layer_state_t state) {
+    return state;
+}
+
+static void layer_state_set(layer_state_t state) {
+    layer_state = layer_state_set_user(state);
+}
+
+void layer_on(uint8_t layer) {
+    layer_state_set(layer_state | ((layer_state_t)1 << layer));
+}
+
+void layer_off(uint8_t layer) {
+    layer_state_set(layer_state & ~((layer_state_t)1 << layer));
+}
+
+bool layer_state_cmp(layer_state_t state, uint8_t layer) {
+    if (!state) {
+        return layer == 0;
+    }
+    return (state & ((layer_state_t)1 << layer)) != 0;
+}
+
+bool layer_state_is(uint8_t layer) {
+    return layer_state_cmp(layer_state, layer);
+}
+
+uint8_t get_highest_layer(layer_state_t state) {
+    return state ? 31 - __builtin_clz(state) : 0;
+}
+
+/** \brief Keycode of a key on the highest active layer where it is not transparent. */
+static uint16_t keymap_keycode(keyevent_t event) {
+    layer_state_t layers = layer_state | default_layer_state;
+    for (int8_t layer = 31; layer >= 0; --layer) {
+        if (!(layers & ((layer_state_t)1 << layer))) {
+            continue;
+        }
+        uint16_t keycode = IS_ENCODEREVENT(event) ? keycode_at_encodermap_location(layer, event.key.col, event.type == ENCODER_CW_EVENT) : keycode_at_keymap_location(layer, event.key.row, event.key.col);
+        if (keycode != KC_TRNS) {
+            return keycode;
+        }
+    }
+    return KC_NO;
+}
+
+/** Keycodes of the pressed keys, so that a key is released on the layer it was pressed on. */
+static uint16_t source_keycodes[MATRIX_ROWS][MATRIX_COLS];
+
+/** \brief Keycode of a record, like `get_record_keycode()`. */
+static uint16_t get_record_keycode(keyrecord_t *record, bool update_layer_cache) {
+    keyevent_t event = record->event;
+    if (!IS_KEYEVENT(event)) {
+        return keymap_keycode(event);
+    }
+    if (!event.pressed) {
+        return source_keycodes[event.key.row][event.key.col];
+    }
+    uint16_t keycode = keymap_keycode(event);
+    if (update_layer_cache) {
+        source_keycodes[event.key.row][event.key.col] = keycode;
+    }
+    return keycode;
+}
+
+/* Deferred execution. */
+
+typedef struct {
+    deferred_token         token;
+    uint32_t               trigger_time;
+    deferred_exec_callback callback;
+    void                  *cb_arg;
+} deferred_executor_t;
+
+static deferred_executor_t deferred_executors[MAX_DEFERRED_EXECUTORS];
+static deferred_token      deferred_last_token = INVALID_DEFERRED_TOKEN;
+
+deferred_token defer_exec(uint32_t delay_ms, deferred_exec_callback callback, void *cb_arg) {
+    if (delay_ms == 0 || callback == NULL) {
+        return INVALID_DEFERRED_TOKEN;
+    }
+    for (uint8_t i = 0; i < MAX_DEFERRED_EXECUTORS; ++i) {
+        deferred_executor_t *entry = &deferred_executors[i];
+        if (entry->token != INVALID_DEFERRED_TOKEN) {
+            continue;
+        }
+        do {
+            ++deferred_last_token;
+        } while (deferred_last_token == INVALID_DEFERRED_TOKEN);
+        *entry = (deferred_executor_t){deferred_last_token, timer_read32() + delay_ms, callback, cb_arg};
+        return entry->token;
+    }
+    return INVALID_DEFERRED_TOKEN;
+}
+
+static deferred_executor_t *deferred_executor(deferred_token token) {
+    for (uint8_t i = 0; token != INVALID_DEFERRED_TOKEN && i < MAX_DEFERRED_EXECUTORS; ++i) {
+        if (deferred_executors[i].token == token) {
+            return &deferred_executors[i];
+        }
+    }
+    return NULL;
+}
+
+bool extend_deferred_exec(deferred_token token, uint32_t delay_ms) {
+    deferred_executor_t *entry = deferred_executor(token);
+    if (entry == NULL || delay_ms == 0) {
+        return false;
+    }
+    entry->trigger_time = timer_read32() + delay_ms;
+    return true;
+}
+
+bool cancel_deferred_exec(deferred_token token) {
+    deferred_executor_t *entry = deferred_executor(token);
+    if (entry == NULL) {
+        return false;
+    }
+    *entry = (deferred_executor_t){0};
+    return true;
+}
+
+static void deferred_exec_task(void) {
+    uint32_t now = timer_read32();
+    for (uint8_t i = 0; i < MAX_DEFERRED_EXECUTORS; ++i) {
+        deferred_executor_t *entry = &deferred_executors[i];
+        if (entry->token == INVALID_DEFERRED_TOKEN || (int32_t)TIMER_DIFF_32(entry->trigger_time, now) > 0) {
+            continue;
+        }
+        uint32_t delay_ms = entry->callback(entry->trigger_time, entry->cb_arg);
+        if (delay_ms > 0) {
+            // Relative to the previous trigger, like QMK.
+            entry->trigger_time += delay_ms;
+        } else {
+            *entry = (deferred_executor_t){0};
+        }
+    }
+}
+
+/* Tap dance. */
+
+#ifdef TAP_DANCE_ENABLE
+static uint16_t active_td     = 0;
+static uint16_t last_tap_time = 0;
+
+void tap_dance_pair_on_each_tap(tap_dance_state_t *state, void *user_data) {
+    tap_dance_pair_t *pair = (tap_dance_pair_t *)user_data;
+    if (state->count == 2) {
+        register_code16(pair->kc2);
+        state->finished = true;
+    }
+}
+
+void tap_dance_pair_finished(tap_dance_state_t *state, void *user_data) {
+    tap_dance_pair_t *pair = (tap_dance_pair_t *)user_data;
+    register_code16(state->count == 1 ? pair->kc1 : pair->kc2);
+}
+
+void tap_dance_pair_reset(tap_dance_state_t *state, void *user_data) {
+    tap_dance_pair_t *pair = (tap_dance_pair_t *)user_data;
+    if (state->count == 1) {
+        wait_ms(TAP_CODE_DELAY);
+    }
+    unregister_code16(state->count == 1 ? pair->kc1 : pair->kc2);
+}
+
+static void tap_dance_call(tap_dance_action_t *action, tap_dance_user_fn_t fn) {
+    if (fn != NULL) {
+        fn(&action->state, action->user_data);
+    }
+}
+
+static void tap_dance_on_reset(tap_dance_action_t *action) {
+    tap_dance_call(action, action->fn.on_reset);
+    del_weak_mods(action->state.weak_mods);
+    send_keyboard_report();
+    action->state = (tap_dance_state_t){0};
+}
+
+static void tap_dance_on_finished(tap_dance_action_t *action) {
+    if (!action->state.finished) {
+        action->state.finished = true;
+        add_weak_mods(action->state.weak_mods);
+        send_keyboard_report();
+        tap_dance_call(action, action->fn.on_dance_finished);
+    }
+    active_td = 0;
+    if (!action->state.pressed) {
+        // There will not be a key release event, so reset now.
+        tap_dance_on_reset(action);
+    }
+}
+
+/** \brief Finish the active tap dance when another key is pressed. */
+static bool preprocess_tap_dance(uint16_t keycode, keyrecord_t *record) {
+    if (!record->event.pressed || !active_td || keycode == active_td) {
+        return false;
+    }
+    tap_dance_action_t *action          = &tap_dance_actions[QK_TAP_DANCE_GET_INDEX(active_td)];
+    action->state.interrupted          = true;
+    action->state.interrupting_keycode = keycode;
+    tap_dance_on_finished(action);
+    clear_weak_mods();
+    return true;
+}
+
+static void process_tap_dance(uint16_t keycode, keyrecord_t *record) {
+    if (!IS_QK_TAP_DANCE(keycode) || QK_TAP_DANCE_GET_INDEX(keycode) >= tap_dance_count()) {
+        return;
+    }
+    tap_dance_action_t *action = &tap_dance_actions[QK_TAP_DANCE_GET_INDEX(keycode)];
+    action->state.pressed      = record->event.pressed;
+    if (record->event.pressed) {
+        last_tap_time = timer_read();
+        action->state.count++;
+        action->state.weak_mods = get_mods() | get_weak_mods();
+        tap_dance_call(action, action->fn.on_each_tap);
+        active_td = action->state.finished ? 0 : keycode;
+    } else {
+        tap_dance_call(action, action->fn.on_each_release);
+        if (action->state.finished) {
+            tap_dance_on_reset(action);
+            if (active_td == keycode) {
+                active_td = 0;
+            }
+        }
+    }
+}
+
+/** The tapping term is queried with an empty record, like QMK. */
+static void tap_dance_task(void) {
+    if (!active_td || timer_elapsed(last_tap_time) <= GET_TAPPING_TERM(active_td, &(keyrecord_t){})) {
+        return;
+    }
+    tap_dance_action_t *action = &tap_dance_actions[QK_TAP_DANCE_GET_INDEX(active_td)];
+    if (!action->state.interrupted) {
+        tap_dance_on_finished(action);
+    }
+}
+#endif // TAP_DANCE_ENABLE
+
+/* Actions. */
+
+static void process_action(uint16_t keycode, keyrecord_t *record) {
+    bool pressed = record->event.pressed;
+
+    if (IS_QK_BASIC(keycode) || IS_QK_MODS(keycode)) {
+        if (pressed) {
+            register_code16(keycode);
+        } else {
+            unregister_code16(keycode);
+        }
+    } else if (IS_QK_MOD_TAP(keycode)) {
+        if (record->tap.count > 0) {
+            if (pressed) {
+                register_code(QK_MOD_TAP_GET_TAP_KEYCODE(keycode));
+            } else {
+                unregister_code(QK_MOD_TAP_GET_TAP_KEYCODE(keycode));
+            }
+        } else if (pressed) {
+            register_mods(mod_config(QK_MOD_TAP_GET_MODS(keycode)));
+        } else {
+            unregister_mods(mod_config(QK_MOD_TAP_GET_MODS(keycode)));
+        }
+    } else if (IS_QK_LAYER_TAP(keycode)) {
+        if (record->tap.count > 0) {
+            if (pressed) {
+                register_code(QK_LAYER_TAP_GET_TAP_KEYCODE(keycode));
+            } else {
+                unregister_code(QK_LAYER_TAP_GET_TAP_KEYCODE(keycode));
+            }
+        } else if (pressed) {
+            layer_on(QK_LAYER_TAP_GET_LAYER(keycode));
+        } else {
+            layer_off(QK_LAYER_TAP_GET_LAYER(keycode));
+        }
+    } else if (IS_QK_MOMENTARY(keycode)) {
+        if (pressed) {
+            layer_on(QK_MOMENTARY_GET_LAYER(keycode));
+        } else {
+            layer_off(QK_MOMENTARY_GET_LAYER(keycode));
+        }
+    }
+}
+
+static void harness_log_record(uint16_t keycode, keyrecord_t *record) {
+    uint32_t delay = TIMER_DIFF_16(timer_read(), record->event.time);
+
+    if (record->event.pressed) {
+        ++harness_statistics.events;
+        harness_statistics.process_delay_max  = MAX(harness_statistics.process_delay_max, delay);
+        harness_statistics.process_delay_sum += delay;
+        if (!harness_report_pending) {
+            harness_report_pending = true;
+            harness_report_press   = record->event.time;
+        }
+    }
+    if (harness_log == NULL) {
+        return;
+    }
+    if (IS_ENCODEREVENT(record->event)) {
+        fprintf(harness_log, "%6u process  enc %u %-3s %-4s", harness_clock, record->event.key.col, record->event.type == ENCODER_CW_EVENT ? "cw" : "ccw", record->event.pressed ? "down" : "up");
+    } else {
+        fprintf(harness_log, "%6u process  r%u c%u   %-4s", harness_clock, record->event.key.row, record->event.key.col, record->event.pressed ? "down" : "up");
+    }
+    fprintf(harness_log, " kc %04X tap %u delay %u\n", keycode, record->tap.count, delay);
+}
+
+static void process_record(keyrecord_t *record) {
+    uint16_t keycode = get_record_keycode(record, true);
+
+#ifdef TAP_DANCE_ENABLE
+    if (preprocess_tap_dance(keycode, record)) {
+        // The tap dance might have changed the layer.
+        keycode = get_record_keycode(record, true);
+    }
+#endif // TAP_DANCE_ENABLE
+    // Logged once the interrupted tap dance has sent its reports, as the
+    // keymap sees the record.
+    harness_log_record(keycode, record);
+    if (!process_record_user(keycode, record)) {
+        return;
+    }
+#ifdef TAP_DANCE_ENABLE
+    process_tap_dance(keycode, record);
+#endif // TAP_DANCE_ENABLE
+    process_action(keycode, record);
+}
+
+/* Tapping. */
+
+static keyrecord_t tapping_key;
+static bool        tapping_key_pending = false;
+static keyrecord_t waiting_buffer[WAITING_BUFFER_SIZE];
+static uint8_t     waiting_buffer_head = 0;
+static uint8_t     waiting_buffer_tail = 0;
+
+static bool is_tap_record(keyrecord_t *record) {
+    uint16_t keycode = get_record_keycode(record, false);
+    return IS_QK_MOD_TAP(keycode) || IS_QK_LAYER_TAP(keycode);
+}
+
+static bool is_same_key(keyevent_t a, keyevent_t b) {
+    return a.type == b.type && a.key.row == b.key.row && a.key.col == b.key.col;
+}
+
+/** \brief Whether the press matching a release is in the waiting buffer. */
+static bool waiting_buffer_typed(keyevent_t event) {
+    for (uint8_t i = waiting_buffer_tail; i != waiting_buffer_head; i = (i + 1) % WAITING_BUFFER_SIZE) {
+        if (is_same_key(waiting_buffer[i].event, event) && waiting_buffer[i].event.pressed) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/** \brief Resolve the pending tap-hold key as a hold. */
+static void tapping_key_hold(void) {
+    tapping_key.tap.count = 0;
+    tapping_key_pending   = false;
+    process_record(&tapping_key);
+}
+
+/**
+ * \brief Feed a record to the tapping state machine.
+ *
+ * Returns false if the record must wait in the buffer, like `process_tapping()`.
+ */
+static bool process_tapping(keyrecord_t *record) {
+    keyevent_t event = record->event;
+    bool       tick  = event.type == TICK_EVENT;
+
+    if (tapping_key_pending) {
+        uint16_t keycode = get_record_keycode(&tapping_key, false);
+        if (TIMER_DIFF_16(event.time, tapping_key.event.time) >= GET_TAPPING_TERM(keycode, &tapping_key)) {
+            tapping_key_hold();
+            return tick;
+        }
+        if (tick) {
+            return true;
+        }
+        if (is_same_key(event, tapping_key.event) && !event.pressed) {
+            // Released within the term: tap.
+            tapping_key.tap.count = 1;
+            tapping_key_pending   = false;
+            process_record(&tapping_key);
+            record->tap.count = 1;
+            process_record(record);
+            return true;
+        }
+        if (!event.pressed && waiting_buffer_typed(event)) {
+#ifdef PERMISSIVE_HOLD
+            // Another key tapped while the key is held: hold.
+            tapping_key_hold();
+#endif // PERMISSIVE_HOLD
+            return false;
+        }
+        if (!event.pressed) {
+            // Release of a key pressed before the tap-hold key.
+            process_record(record);
+            return true;
+        }
+        return false;
+    }
+    if (tick) {
+        return true;
+    }
+    if (event.pressed && is_tap_record(record)) {
+        tapping_key         = *record;
+        tapping_key_pending = true;
+        return true;
+    }
+    process_record(record);
+    return true;
+}
+
+static void action_tapping_process(keyrecord_t record) {
+    if (!process_tapping(&record) && record.event.type != TICK_EVENT) {
+        waiting_buffer[waiting_buffer_head] = record;
+        waiting_buffer_head                 = (waiting_buffer_head + 1) % WAITING_BUFFER_SIZE;
+    }
+    while (waiting_buffer_tail != waiting_buffer_head && process_tapping(&waiting_buffer[waiting_buffer_tail])) {
+        waiting_buffer_tail = (waiting_buffer_tail + 1) % WAITING_BUFFER_SIZE;
+    }
+}
+
+__attribute__((weak)) bool pre_process_record_user(uint16_t keycode, keyrecord_t *record) {
+    return true;
+}
+
+__attribute__((weak)) bool process_record_user(uint16_t keycode, keyrecord_t *record) {
+    return true;
+}
+
+__attribute__((weak)) void matrix_scan_user(void) {}
+
+__attribute__((weak)) void housekeeping_task_user(void) {}
+
+static void action_exec(keyevent_t event) {
+    keyrecord_t record = {.event = event};
+    if (event.type != TICK_EVENT && !pre_process_record_user(get_record_keycode(&record, false), &record)) {
+        return;
+    }
+    action_tapping_process(record);
+}
+
+/* Driver. */
+
+/**
+ * QMK sets the lowest bit of the event times, so that 0 never is a valid time.
+ * The harness keeps the exact time instead, so that the delays it reports are
+ * not off by one millisecond.
+ */
+static keyevent_t harness_event(uint8_t row, uint8_t col, keyevent_type_t type, bool pressed) {
+    return (keyevent_t){.key = {.col = col, .row = row}, .time = timer_read(), .type = type, .pressed = pressed};
+}
+
+void harness_init(void) {
+    harness_clock = 0;
+    host_set_driver(&harness_driver);
+}
+
+uint32_t harness_now(void) {
+    return harness_clock;
+}
+
+void harness_scan_begin(void) {
+    harness_scan_has_events = false;
+    matrix_scan_user();
+}
+
+void harness_key(uint8_t row, uint8_t col, bool pressed) {
+    harness_scan_has_events = true;
+    action_exec(harness_event(row, col, KEY_EVENT, pressed));
+}
+
+/** Pressed and released at once, like `encoder_exec_mapping()`. */
+void harness_encoder(uint8_t index, bool clockwise) {
+    keyevent_type_t type    = clockwise ? ENCODER_CW_EVENT : ENCODER_CCW_EVENT;
+    uint8_t         row     = clockwise ? KEYLOC_ENCODER_CW : KEYLOC_ENCODER_CCW;
+    harness_scan_has_events = true;
+    action_exec(harness_event(row, index, type, true));
+    action_exec(harness_event(row, index, type, false));
+}
+
+void harness_scan_end(void) {
+    if (!harness_scan_has_events) {
+        action_exec(harness_event(0, 0, TICK_EVENT, false));
+    }
+#ifdef TAP_DANCE_ENABLE
+    tap_dance_task();
+#endif // TAP_DANCE_ENABLE
+    deferred_exec_task();
+    housekeeping_task_user();
+    ++harness_clock;
+}
+
+bool harness_idle(void) {
+    if (tapping_key_pending || waiting_buffer_tail != waiting_buffer_head) {
+        return false;
+    }
+#ifdef TAP_DANCE_ENABLE
+    if (active_td) {
+        return false;
+    }
+#endif // TAP_DANCE_ENABLE
+    for (uint8_t i = 0; i < MAX_DEFERRED_EXECUTORS; ++i) {
+        if (deferred_executors[i].token != INVALID_DEFERRED_TOKEN) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const harness_stats_t *harness_stats(void) {
+    return &harness_statistics;
+}
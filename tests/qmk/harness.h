@@ -0,0 +1,56 @@
+/**
+ * Copyright 2021 Charly Delay <charly@codesink.dev> (@0xcharly)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/*
+ * Driver interface of the stubbed QMK core.
+ *
+ * A scan is one millisecond of the virtual clock: it starts with
+ * `harness_scan_begin()`, feeds the key and encoder events of the
+ * millisecond, and runs the tasks of the core in `harness_scan_end()`.
+ */
+
+#include <stdio.h>
+#include QMK_KEYBOARD_H
+
+typedef struct {
+    uint32_t events;              // Key and encoder presses processed.
+    uint32_t reports;             // Keyboard and consumer reports sent.
+    uint32_t process_delay_max;   // Press scanned to processed, in ms.
+    uint32_t process_delay_sum;   //
+    uint32_t report_delay_max;    // Oldest unreported press to report, in ms.
+    uint32_t report_delay_sum;    //
+    uint32_t report_delay_count;  //
+} harness_stats_t;
+
+/** \brief Where the processed records and the reports are logged, `NULL` to stay silent. */
+extern FILE *harness_log;
+
+/** \brief Start the core: install the logging host driver, at time 0. */
+void harness_init(void);
+
+uint32_t harness_now(void);
+
+void harness_scan_begin(void);
+void harness_key(uint8_t row, uint8_t col, bool pressed);
+void harness_encoder(uint8_t index, bool clockwise);
+void harness_scan_end(void);
+
+/** \brief Whether no decision, tap dance or deferred callback is pending. */
+bool harness_idle(void);
+
+const harness_stats_t *harness_stats(void);
@@ -0,0 +1,65 @@
+/**
+ * Copyright 2021 Charly Delay <charly@codesink.dev> (@0xcharly)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Keymap introspection.
+ *
+ * Like QMK's `keymap_introspection.c`, this file includes the keymap, given as
+ * `KEYMAP_C`, so that the size of its tables is known to the core.
+ */
+
+#include KEYMAP_C
+
+uint8_t keymap_layer_count(void) {
+    return ARRAY_SIZE(keymaps);
+}
+
+uint16_t keycode_at_keymap_location(uint8_t layer, uint8_t row, uint8_t col) {
+    if (layer >= keymap_layer_count() || row >= MATRIX_ROWS || col >= MATRIX_COLS) {
+        return KC_TRNS;
+    }
+    return pgm_read_word(&keymaps[layer][row][col]);
+}
+
+#ifdef ENCODER_MAP_ENABLE
+uint8_t encodermap_layer_count(void) {
+    return ARRAY_SIZE(encoder_map);
+}
+
+uint16_t keycode_at_encodermap_location(uint8_t layer, uint8_t encoder_idx, bool clockwise) {
+    if (layer >= encodermap_layer_count() || encoder_idx >= NUM_ENCODERS) {
+        return KC_TRNS;
+    }
+    return pgm_read_word(&encoder_map[layer][encoder_idx][clockwise ? 0 : 1]);
+}
+#else
+uint8_t encodermap_layer_count(void) {
+    return 0;
+}
+
+uint16_t keycode_at_encodermap_location(uint8_t layer, uint8_t encoder_idx, bool clockwise) {
+    return KC_TRNS;
+}
+#endif // ENCODER_MAP_ENABLE
+
+uint16_t tap_dance_count(void) {
+#ifdef TAP_DANCE_ENABLE
+    return ARRAY_SIZE(tap_dance_actions);
+#else
+    return 0;
+#endif // TAP_DANCE_ENABLE
+}
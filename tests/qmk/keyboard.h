@@ -0,0 +1,82 @@
+/**
+ * Copyright 2021 Charly Delay <charly@codesink.dev> (@0xcharly)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/*
+ * Dilemma Max (4x6_4) as seen by the host harness.
+ *
+ * Split matrix of 10 rows of 6 columns: the left half on rows 0 to 4 and the
+ * right half on rows 5 to 9, columns numbered left to right on both halves.
+ * The four thumb keys of each half sit on columns 1 to 4 of the last row.
+ * Traces recorded on a board whose matrix is wired differently must be
+ * translated to these positions before being replayed.
+ */
+
+#define MATRIX_ROWS 10
+#define MATRIX_COLS 6
+#define NUM_ENCODERS 2
+
+#include "quantum.h"
+
+#ifdef POINTING_DEVICE_ENABLE
+/* Keycodes and pointer settings of the board, see `dilemma.h`. */
+enum dilemma_keycodes {
+    POINTER_DEFAULT_DPI_FORWARD = QK_KB,
+    POINTER_DEFAULT_DPI_REVERSE,
+    POINTER_SNIPING_DPI_FORWARD,
+    POINTER_SNIPING_DPI_REVERSE,
+    SNIPING_MODE,
+    SNIPING_MODE_TOGGLE,
+    DRAGSCROLL_MODE,
+    DRAGSCROLL_TOGGLE,
+};
+
+#    define DPI_MOD POINTER_DEFAULT_DPI_FORWARD
+#    define DPI_RMOD POINTER_DEFAULT_DPI_REVERSE
+#    define S_D_MOD POINTER_SNIPING_DPI_FORWARD
+#    define S_D_RMOD POINTER_SNIPING_DPI_REVERSE
+#    define SNIPING SNIPING_MODE
+#    define SNP_TOG SNIPING_MODE_TOGGLE
+#    define DRGSCRL DRAGSCROLL_MODE
+#    define DRG_TOG DRAGSCROLL_TOGGLE
+
+uint16_t dilemma_get_pointer_default_dpi(void);
+uint16_t dilemma_get_pointer_sniping_dpi(void);
+bool     dilemma_get_pointer_sniping_enabled(void);
+void     dilemma_set_pointer_sniping_enabled(bool enable);
+#endif // POINTING_DEVICE_ENABLE
+
+// clang-format off
+#define LAYOUT( \
+    L00, L01, L02, L03, L04, L05,           R00, R01, R02, R03, R04, R05, \
+    L10, L11, L12, L13, L14, L15,           R10, R11, R12, R13, R14, R15, \
+    L20, L21, L22, L23, L24, L25,           R20, R21, R22, R23, R24, R25, \
+    L30, L31, L32, L33, L34, L35,           R30, R31, R32, R33, R34, R35, \
+              L41, L42, L43, L44,           R41, R42, R43, R44            \
+) { \
+    {   L00,   L01,   L02,   L03,   L04,   L05 }, \
+    {   L10,   L11,   L12,   L13,   L14,   L15 }, \
+    {   L20,   L21,   L22,   L23,   L24,   L25 }, \
+    {   L30,   L31,   L32,   L33,   L34,   L35 }, \
+    { KC_NO,   L41,   L42,   L43,   L44, KC_NO }, \
+    {   R00,   R01,   R02,   R03,   R04,   R05 }, \
+    {   R10,   R11,   R12,   R13,   R14,   R15 }, \
+    {   R20,   R21,   R22,   R23,   R24,   R25 }, \
+    {   R30,   R31,   R32,   R33,   R34,   R35 }, \
+    { KC_NO,   R41,   R42,   R43,   R44, KC_NO }, \
+}
+// clang-format on
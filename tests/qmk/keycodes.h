@@ -0,0 +1,311 @@
+/**
+ * Copyright 2021 Charly Delay <charly@codesink.dev> (@0xcharly)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/*
+ * Keycodes of the host harness.
+ *
+ * A subset of QMK's `keycodes.h` and `quantum_keycodes.h`, with the same
+ * values, covering the keycodes used by the `vendor` keymaps built on the
+ * host.
+ */
+
+enum qk_keycode_ranges {
+    QK_BASIC                = 0x0000,
+    QK_BASIC_MAX            = 0x00FF,
+    QK_MODS                 = 0x0100,
+    QK_MODS_MAX             = 0x1FFF,
+    QK_MOD_TAP              = 0x2000,
+    QK_MOD_TAP_MAX          = 0x3FFF,
+    QK_LAYER_TAP            = 0x4000,
+    QK_LAYER_TAP_MAX        = 0x4FFF,
+    QK_MOMENTARY            = 0x5220,
+    QK_MOMENTARY_MAX        = 0x523F,
+    QK_TAP_DANCE            = 0x5700,
+    QK_TAP_DANCE_MAX        = 0x57FF,
+    QK_LIGHTING             = 0x7800,
+    QK_LIGHTING_MAX         = 0x78FF,
+    QK_QUANTUM              = 0x7C00,
+    QK_QUANTUM_MAX          = 0x7DFF,
+    QK_KB                   = 0x7E00,
+    QK_KB_MAX               = 0x7E3F,
+    QK_USER                 = 0x7E40,
+    QK_USER_MAX             = 0x7FFF,
+};
+
+enum qk_keycode_defines {
+    KC_NO                   = 0x0000,
+    KC_TRANSPARENT          = 0x0001,
+    KC_A                    = 0x0004,
+    KC_B                    = 0x0005,
+    KC_C                    = 0x0006,
+    KC_D                    = 0x0007,
+    KC_E                    = 0x0008,
+    KC_F                    = 0x0009,
+    KC_G                    = 0x000A,
+    KC_H                    = 0x000B,
+    KC_I                    = 0x000C,
+    KC_J                    = 0x000D,
+    KC_K                    = 0x000E,
+    KC_L                    = 0x000F,
+    KC_M                    = 0x0010,
+    KC_N                    = 0x0011,
+    KC_O                    = 0x0012,
+    KC_P                    = 0x0013,
+    KC_Q                    = 0x0014,
+    KC_R                    = 0x0015,
+    KC_S                    = 0x0016,
+    KC_T                    = 0x0017,
+    KC_U                    = 0x0018,
+    KC_V                    = 0x0019,
+    KC_W                    = 0x001A,
+    KC_X                    = 0x001B,
+    KC_Y                    = 0x001C,
+    KC_Z                    = 0x001D,
+    KC_1                    = 0x001E,
+    KC_2                    = 0x001F,
+    KC_3                    = 0x0020,
+    KC_4                    = 0x0021,
+    KC_5                    = 0x0022,
+    KC_6                    = 0x0023,
+    KC_7                    = 0x0024,
+    KC_8                    = 0x0025,
+    KC_9                    = 0x0026,
+    KC_0                    = 0x0027,
+    KC_ENTER                = 0x0028,
+    KC_ESCAPE               = 0x0029,
+    KC_BACKSPACE            = 0x002A,
+    KC_TAB                  = 0x002B,
+    KC_SPACE                = 0x002C,
+    KC_MINUS                = 0x002D,
+    KC_EQUAL                = 0x002E,
+    KC_LEFT_BRACKET         = 0x002F,
+    KC_RIGHT_BRACKET        = 0x0030,
+    KC_BACKSLASH            = 0x0031,
+    KC_NONUS_HASH           = 0x0032,
+    KC_SEMICOLON            = 0x0033,
+    KC_QUOTE                = 0x0034,
+    KC_GRAVE                = 0x0035,
+    KC_COMMA                = 0x0036,
+    KC_DOT                  = 0x0037,
+    KC_SLASH                = 0x0038,
+    KC_CAPS_LOCK            = 0x0039,
+    KC_F1                   = 0x003A,
+    KC_F2                   = 0x003B,
+    KC_F3                   = 0x003C,
+    KC_F4                   = 0x003D,
+    KC_F5                   = 0x003E,
+    KC_F6                   = 0x003F,
+    KC_F7                   = 0x0040,
+    KC_F8                   = 0x0041,
+    KC_F9                   = 0x0042,
+    KC_F10                  = 0x0043,
+    KC_F11                  = 0x0044,
+    KC_F12                  = 0x0045,
+    KC_PRINT_SCREEN         = 0x0046,
+    KC_SCROLL_LOCK          = 0x0047,
+    KC_PAUSE                = 0x0048,
+    KC_INSERT               = 0x0049,
+    KC_HOME                 = 0x004A,
+    KC_PAGE_UP              = 0x004B,
+    KC_DELETE               = 0x004C,
+    KC_END                  = 0x004D,
+    KC_PAGE_DOWN            = 0x004E,
+    KC_RIGHT                = 0x004F,
+    KC_LEFT                 = 0x0050,
+    KC_DOWN                 = 0x0051,
+    KC_UP                   = 0x0052,
+    KC_NUM_LOCK             = 0x0053,
+    KC_KP_SLASH             = 0x0054,
+    KC_KP_ASTERISK          = 0x0055,
+    KC_KP_MINUS             = 0x0056,
+    KC_KP_PLUS              = 0x0057,
+    KC_KP_ENTER             = 0x0058,
+    KC_KP_1                 = 0x0059,
+    KC_KP_2                 = 0x005A,
+    KC_KP_3                 = 0x005B,
+    KC_KP_4                 = 0x005C,
+    KC_KP_5                 = 0x005D,
+    KC_KP_6                 = 0x005E,
+    KC_KP_7                 = 0x005F,
+    KC_KP_8                 = 0x0060,
+    KC_KP_9                 = 0x0061,
+    KC_KP_0                 = 0x0062,
+    KC_KP_DOT               = 0x0063,
+    KC_NONUS_BACKSLASH      = 0x0064,
+    KC_APPLICATION          = 0x0065,
+    KC_KP_EQUAL             = 0x0067,
+    KC_EXSEL                = 0x00A4,
+    KC_AUDIO_MUTE           = 0x00A8,
+    KC_AUDIO_VOL_UP         = 0x00A9,
+    KC_AUDIO_VOL_DOWN       = 0x00AA,
+    KC_MEDIA_NEXT_TRACK     = 0x00AB,
+    KC_MEDIA_PREV_TRACK     = 0x00AC,
+    KC_MEDIA_STOP           = 0x00AD,
+    KC_MEDIA_PLAY_PAUSE     = 0x00AE,
+    KC_MS_BTN1              = 0x00D1,
+    KC_MS_BTN2              = 0x00D2,
+    KC_MS_BTN3              = 0x00D3,
+    KC_MS_WH_UP             = 0x00D9,
+    KC_MS_WH_DOWN           = 0x00DA,
+    KC_LEFT_CTRL            = 0x00E0,
+    KC_LEFT_SHIFT           = 0x00E1,
+    KC_LEFT_ALT             = 0x00E2,
+    KC_LEFT_GUI             = 0x00E3,
+    KC_RIGHT_CTRL           = 0x00E4,
+    KC_RIGHT_SHIFT          = 0x00E5,
+    KC_RIGHT_ALT            = 0x00E6,
+    KC_RIGHT_GUI            = 0x00E7,
+    RGB_TOG                 = 0x7820,
+    RGB_MODE_FORWARD        = 0x7821,
+    RGB_MODE_REVERSE        = 0x7822,
+    RGB_HUI                 = 0x7823,
+    RGB_HUD                 = 0x7824,
+    RGB_SAI                 = 0x7825,
+    RGB_SAD                 = 0x7826,
+    RGB_VAI                 = 0x7827,
+    RGB_VAD                 = 0x7828,
+    RGB_SPI                 = 0x7829,
+    RGB_SPD                 = 0x782A,
+    QK_BOOTLOADER           = 0x7C00,
+    QK_CLEAR_EEPROM         = 0x7C03,
+    SAFE_RANGE              = QK_USER,
+};
+
+#define XXXXXXX KC_NO
+#define _______ KC_TRANSPARENT
+#define KC_TRNS KC_TRANSPARENT
+#define KC_ENT KC_ENTER
+#define KC_ESC KC_ESCAPE
+#define KC_BSPC KC_BACKSPACE
+#define KC_SPC KC_SPACE
+#define KC_MINS KC_MINUS
+#define KC_EQL KC_EQUAL
+#define KC_LBRC KC_LEFT_BRACKET
+#define KC_RBRC KC_RIGHT_BRACKET
+#define KC_BSLS KC_BACKSLASH
+#define KC_NUHS KC_NONUS_HASH
+#define KC_SCLN KC_SEMICOLON
+#define KC_QUOT KC_QUOTE
+#define KC_GRV KC_GRAVE
+#define KC_COMM KC_COMMA
+#define KC_SLSH KC_SLASH
+#define KC_CAPS KC_CAPS_LOCK
+#define KC_PSCR KC_PRINT_SCREEN
+#define KC_SCRL KC_SCROLL_LOCK
+#define KC_PAUS KC_PAUSE
+#define KC_INS KC_INSERT
+#define KC_PGUP KC_PAGE_UP
+#define KC_DEL KC_DELETE
+#define KC_PGDN KC_PAGE_DOWN
+#define KC_RGHT KC_RIGHT
+#define KC_NUM KC_NUM_LOCK
+#define KC_PSLS KC_KP_SLASH
+#define KC_PAST KC_KP_ASTERISK
+#define KC_PMNS KC_KP_MINUS
+#define KC_PPLS KC_KP_PLUS
+#define KC_PENT KC_KP_ENTER
+#define KC_P1 KC_KP_1
+#define KC_P2 KC_KP_2
+#define KC_P3 KC_KP_3
+#define KC_P4 KC_KP_4
+#define KC_P5 KC_KP_5
+#define KC_P6 KC_KP_6
+#define KC_P7 KC_KP_7
+#define KC_P8 KC_KP_8
+#define KC_P9 KC_KP_9
+#define KC_P0 KC_KP_0
+#define KC_PDOT KC_KP_DOT
+#define KC_NUBS KC_NONUS_BACKSLASH
+#define KC_APP KC_APPLICATION
+#define KC_PEQL KC_KP_EQUAL
+#define KC_MUTE KC_AUDIO_MUTE
+#define KC_VOLU KC_AUDIO_VOL_UP
+#define KC_VOLD KC_AUDIO_VOL_DOWN
+#define KC_MNXT KC_MEDIA_NEXT_TRACK
+#define KC_MPRV KC_MEDIA_PREV_TRACK
+#define KC_MSTP KC_MEDIA_STOP
+#define KC_MPLY KC_MEDIA_PLAY_PAUSE
+#define KC_BTN1 KC_MS_BTN1
+#define KC_BTN2 KC_MS_BTN2
+#define KC_BTN3 KC_MS_BTN3
+#define KC_WH_U KC_MS_WH_UP
+#define KC_WH_D KC_MS_WH_DOWN
+#define KC_LCTL KC_LEFT_CTRL
+#define KC_LSFT KC_LEFT_SHIFT
+#define KC_LALT KC_LEFT_ALT
+#define KC_LGUI KC_LEFT_GUI
+#define KC_RCTL KC_RIGHT_CTRL
+#define KC_RSFT KC_RIGHT_SHIFT
+#define KC_RALT KC_RIGHT_ALT
+#define KC_RGUI KC_RIGHT_GUI
+#define RGB_MOD RGB_MODE_FORWARD
+#define RGB_RMOD RGB_MODE_REVERSE
+#define QK_BOOT QK_BOOTLOADER
+#define EE_CLR QK_CLEAR_EEPROM
+
+/* Modifiers, as the 5-bit mask of the keycodes. */
+#define MOD_LCTL 0x01
+#define MOD_LSFT 0x02
+#define MOD_LALT 0x04
+#define MOD_LGUI 0x08
+#define MOD_RCTL 0x11
+#define MOD_RSFT 0x12
+#define MOD_RALT 0x14
+#define MOD_RGUI 0x18
+#define MOD_MEH 0x07
+#define MOD_HYPR 0x0F
+
+/* Modifiers, as the 8-bit mask of the HID report. */
+#define MOD_BIT(kc) (1 << ((kc) & 0x07))
+#define MOD_MASK_SHIFT (MOD_BIT(KC_LSFT) | MOD_BIT(KC_RSFT))
+
+#define LCTL(kc) (0x0100 | (kc))
+#define LSFT(kc) (0x0200 | (kc))
+#define LALT(kc) (0x0400 | (kc))
+#define LGUI(kc) (0x0800 | (kc))
+#define RCTL(kc) (0x1100 | (kc))
+#define RSFT(kc) (0x1200 | (kc))
+#define RALT(kc) (0x1400 | (kc))
+#define RGUI(kc) (0x1800 | (kc))
+#define S(kc) LSFT(kc)
+#define ALGR(kc) RALT(kc)
+
+#define MT(mod, kc) (QK_MOD_TAP | (((mod) & 0x1F) << 8) | ((kc) & 0xFF))
+#define LT(layer, kc) (QK_LAYER_TAP | (((layer) & 0xF) << 8) | ((kc) & 0xFF))
+#define MO(layer) (QK_MOMENTARY | ((layer) & 0x1F))
+#define TD(i) (QK_TAP_DANCE | ((i) & 0xFF))
+
+#define QK_MODS_GET_MODS(kc) (((kc) >> 8) & 0x1F)
+#define QK_MODS_GET_BASIC_KEYCODE(kc) ((kc) & 0xFF)
+#define QK_MOD_TAP_GET_MODS(kc) (((kc) >> 8) & 0x1F)
+#define QK_MOD_TAP_GET_TAP_KEYCODE(kc) ((kc) & 0xFF)
+#define QK_LAYER_TAP_GET_LAYER(kc) (((kc) >> 8) & 0xF)
+#define QK_LAYER_TAP_GET_TAP_KEYCODE(kc) ((kc) & 0xFF)
+#define QK_MOMENTARY_GET_LAYER(kc) ((kc) & 0x1F)
+#define QK_TAP_DANCE_GET_INDEX(kc) ((kc) & 0xFF)
+
+#define IS_QK_BASIC(code) ((code) >= QK_BASIC && (code) <= QK_BASIC_MAX)
+#define IS_QK_MODS(code) ((code) >= QK_MODS && (code) <= QK_MODS_MAX)
+#define IS_QK_MOD_TAP(code) ((code) >= QK_MOD_TAP && (code) <= QK_MOD_TAP_MAX)
+#define IS_QK_LAYER_TAP(code) ((code) >= QK_LAYER_TAP && (code) <= QK_LAYER_TAP_MAX)
+#define IS_QK_MOMENTARY(code) ((code) >= QK_MOMENTARY && (code) <= QK_MOMENTARY_MAX)
+#define IS_QK_TAP_DANCE(code) ((code) >= QK_TAP_DANCE && (code) <= QK_TAP_DANCE_MAX)
+
+#define IS_BASIC_KEYCODE(code) ((code) >= KC_A && (code) <= KC_EXSEL)
+#define IS_CONSUMER_KEYCODE(code) ((code) >= KC_AUDIO_MUTE && (code) <= KC_MEDIA_PLAY_PAUSE)
+#define IS_MODIFIER_KEYCODE(code) ((code) >= KC_LEFT_CTRL && (code) <= KC_RIGHT_GUI)
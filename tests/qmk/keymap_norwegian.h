@@ -0,0 +1,28 @@
+/**
+ * Copyright 2021 Charly Delay <charly@codesink.dev> (@0xcharly)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "keycodes.h"
+
+/* Subset of QMK's `keymap_norwegian.h`, with the same values. */
+
+#define NO_7 KC_7
+#define NO_0 KC_0
+#define NO_DOT KC_DOT
+#define NO_LCBR ALGR(NO_7) // {
+#define NO_RCBR ALGR(NO_0) // }
+#define NO_COLN S(NO_DOT)  // :
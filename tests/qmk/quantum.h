@@ -0,0 +1,272 @@
+/**
+ * Copyright 2021 Charly Delay <charly@codesink.dev> (@0xcharly)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/*
+ * Stubbed QMK core of the host harness.
+ *
+ * Declares the subset of the QMK API used by the `vendor` keymaps, with the
+ * same names and semantics.  Implemented by `core.c` on top of a virtual
+ * millisecond clock.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "keycodes.h"
+
+#define PROGMEM
+#define pgm_read_word(address) (*(const uint16_t *)(address))
+
+#ifndef MIN
+#    define MIN(x, y) ((x) < (y) ? (x) : (y))
+#endif // MIN
+#ifndef MAX
+#    define MAX(x, y) ((x) > (y) ? (x) : (y))
+#endif // MAX
+#define ARRAY_SIZE(array) (sizeof(array) / sizeof((array)[0]))
+
+#ifndef TAPPING_TERM
+#    define TAPPING_TERM 200
+#endif // TAPPING_TERM
+
+#ifndef TAP_CODE_DELAY
+#    define TAP_CODE_DELAY 0
+#endif // TAP_CODE_DELAY
+
+#ifndef NUM_ENCODERS
+#    define NUM_ENCODERS 0
+#endif // NUM_ENCODERS
+#define NUM_DIRECTIONS 2
+#define ENCODER_CCW_CW(ccw, cw) \
+    { (cw), (ccw) }
+
+/* Timer. */
+
+#define TIMER_DIFF_16(a, b) ((uint16_t)((a) - (b)))
+#define TIMER_DIFF_32(a, b) ((uint32_t)((a) - (b)))
+
+uint16_t timer_read(void);
+uint32_t timer_read32(void);
+uint16_t timer_elapsed(uint16_t last);
+uint32_t timer_elapsed32(uint32_t last);
+void     wait_ms(uint32_t ms);
+
+/* Key events. */
+
+typedef struct {
+    uint8_t col;
+    uint8_t row;
+} keypos_t;
+
+typedef enum {
+    TICK_EVENT        = 0,
+    KEY_EVENT         = 1,
+    ENCODER_CW_EVENT  = 2,
+    ENCODER_CCW_EVENT = 3,
+} keyevent_type_t;
+
+typedef struct {
+    keypos_t        key;
+    uint16_t        time;
+    keyevent_type_t type;
+    bool            pressed;
+} keyevent_t;
+
+typedef struct {
+    bool    interrupted : 1;
+    bool    reserved2 : 1;
+    bool    reserved1 : 1;
+    bool    reserved0 : 1;
+    uint8_t count : 4;
+} tap_t;
+
+typedef struct {
+    keyevent_t event;
+    tap_t      tap;
+} keyrecord_t;
+
+#define KEYLOC_ENCODER_CW 253
+#define KEYLOC_ENCODER_CCW 252
+
+#define IS_KEYEVENT(event) ((event).type == KEY_EVENT)
+#define IS_ENCODEREVENT(event) ((event).type == ENCODER_CW_EVENT || (event).type == ENCODER_CCW_EVENT)
+
+/* Tapping. */
+
+#ifdef TAPPING_TERM_PER_KEY
+#    define GET_TAPPING_TERM(keycode, record) get_tapping_term(keycode, record)
+uint16_t get_tapping_term(uint16_t keycode, keyrecord_t *record);
+#else
+#    define GET_TAPPING_TERM(keycode, record) (TAPPING_TERM)
+#endif // TAPPING_TERM_PER_KEY
+
+/* Layers. */
+
+typedef uint32_t layer_state_t;
+
+extern layer_state_t layer_state;
+extern layer_state_t default_layer_state;
+
+void          layer_on(uint8_t layer);
+void          layer_off(uint8_t layer);
+bool          layer_state_is(uint8_t layer);
+bool          layer_state_cmp(layer_state_t state, uint8_t layer);
+uint8_t       get_highest_layer(layer_state_t state);
+layer_state_t layer_state_set_user(layer_state_t state);
+
+/* Reports. */
+
+typedef struct {
+    uint8_t mods;
+    uint8_t reserved;
+    uint8_t keys[6];
+} report_keyboard_t;
+
+typedef struct {
+    uint8_t report_id;
+    uint8_t mods;
+    uint8_t bits[30];
+} report_nkro_t;
+
+#ifdef MOUSE_EXTENDED_REPORT
+typedef int16_t mouse_xy_report_t;
+#else
+typedef int8_t mouse_xy_report_t;
+#endif // MOUSE_EXTENDED_REPORT
+
+#ifdef WHEEL_EXTENDED_REPORT
+typedef int16_t mouse_hv_report_t;
+#else
+typedef int8_t mouse_hv_report_t;
+#endif // WHEEL_EXTENDED_REPORT
+
+typedef struct {
+    uint8_t           buttons;
+    mouse_xy_report_t x;
+    mouse_xy_report_t y;
+    mouse_hv_report_t v;
+    mouse_hv_report_t h;
+} report_mouse_t;
+
+typedef struct {
+    uint8_t  report_id;
+    uint16_t usage;
+} report_extra_t;
+
+void    add_key(uint8_t key);
+void    del_key(uint8_t key);
+void    clear_keys(void);
+uint8_t get_mods(void);
+void    add_mods(uint8_t mods);
+void    del_mods(uint8_t mods);
+void    clear_mods(void);
+uint8_t get_weak_mods(void);
+void    add_weak_mods(uint8_t mods);
+void    del_weak_mods(uint8_t mods);
+void    clear_weak_mods(void);
+void    send_keyboard_report(void);
+
+void register_code(uint8_t code);
+void unregister_code(uint8_t code);
+void tap_code(uint8_t code);
+void register_code16(uint16_t code);
+void unregister_code16(uint16_t code);
+void tap_code16(uint16_t code);
+void register_mods(uint8_t mods);
+void unregister_mods(uint8_t mods);
+
+/* Deferred execution. */
+
+typedef uint8_t deferred_token;
+typedef uint32_t (*deferred_exec_callback)(uint32_t trigger_time, void *cb_arg);
+
+#define INVALID_DEFERRED_TOKEN 0
+
+deferred_token defer_exec(uint32_t delay_ms, deferred_exec_callback callback, void *cb_arg);
+bool           extend_deferred_exec(deferred_token token, uint32_t delay_ms);
+bool           cancel_deferred_exec(deferred_token token);
+
+/* Pointing device, implemented by the tests that use it. */
+
+#ifdef POINTING_DEVICE_ENABLE
+report_mouse_t pointing_device_get_report(void);
+void           pointing_device_set_report(report_mouse_t mouse_report);
+bool           pointing_device_send(void);
+uint16_t       pointing_device_get_cpi(void);
+void           pointing_device_set_cpi(uint16_t cpi);
+#    ifdef POINTING_DEVICE_HIRES_SCROLL_ENABLE
+uint16_t pointing_device_get_hires_scroll_resolution(void);
+#    endif // POINTING_DEVICE_HIRES_SCROLL_ENABLE
+#endif     // POINTING_DEVICE_ENABLE
+
+/* Tap dance. */
+
+#ifdef TAP_DANCE_ENABLE
+typedef struct {
+    uint16_t interrupting_keycode;
+    uint8_t  count;
+    uint8_t  weak_mods;
+    bool     pressed : 1;
+    bool     finished : 1;
+    bool     interrupted : 1;
+} tap_dance_state_t;
+
+typedef void (*tap_dance_user_fn_t)(tap_dance_state_t *state, void *user_data);
+
+typedef struct {
+    tap_dance_state_t state;
+    struct {
+        tap_dance_user_fn_t on_each_tap;
+        tap_dance_user_fn_t on_dance_finished;
+        tap_dance_user_fn_t on_reset;
+        tap_dance_user_fn_t on_each_release;
+    } fn;
+    void *user_data;
+} tap_dance_action_t;
+
+typedef struct {
+    uint16_t kc1;
+    uint16_t kc2;
+} tap_dance_pair_t;
+
+#    define ACTION_TAP_DANCE_DOUBLE(kc1, kc2) \
+        { .fn = {tap_dance_pair_on_each_tap, tap_dance_pair_finished, tap_dance_pair_reset, NULL}, .user_data = (void *)&((tap_dance_pair_t){kc1, kc2}), }
+
+extern tap_dance_action_t tap_dance_actions[];
+
+void tap_dance_pair_on_each_tap(tap_dance_state_t *state, void *user_data);
+void tap_dance_pair_finished(tap_dance_state_t *state, void *user_data);
+void tap_dance_pair_reset(tap_dance_state_t *state, void *user_data);
+#endif // TAP_DANCE_ENABLE
+
+/* Introspection of the keymap, see `introspection.c`. */
+
+uint8_t  keymap_layer_count(void);
+uint16_t keycode_at_keymap_location(uint8_t layer, uint8_t row, uint8_t col);
+uint8_t  encodermap_layer_count(void);
+uint16_t keycode_at_encodermap_location(uint8_t layer, uint8_t encoder_idx, bool clockwise);
+uint16_t tap_dance_count(void);
+
+/* User callbacks, weakly defined by the core. */
+
+bool pre_process_record_user(uint16_t keycode, keyrecord_t *record);
+bool process_record_user(uint16_t keycode, keyrecord_t *record);
+void matrix_scan_user(void);
+void housekeeping_task_user(void);
@@ -0,0 +1,32 @@
+/**
+ * Copyright 2021 Charly Delay <charly@codesink.dev> (@0xcharly)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "quantum.h"
+
+enum via_command_id {
+    id_custom_set_value = 0x07,
+    id_custom_get_value = 0x08,
+    id_custom_save      = 0x09,
+    id_unhandled        = 0xFF,
+};
+
+enum via_channel_id {
+    id_custom_channel = 0,
+};
+
+void via_custom_value_command_user(uint8_t *data, uint8_t length);
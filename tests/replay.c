@@ -0,0 +1,307 @@
+/**
+ * Copyright 2021 Charly Delay <charly@codesink.dev> (@0xcharly)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Replay a key event trace through a keymap built against the stubbed core.
+ *
+ * Usage: replay [--bench RUNS | --raw-hid] TRACE
+ *
+ * A trace has one event per line, with its time in milliseconds:
+ *
+ *     <time> <row> <col> down|up
+ *     <time> enc <index> cw|ccw
+ *
+ * Anything up to `trace: ` is ignored, so that the output of `qmk console`
+ * can be replayed as is, and `#` starts a comment.
+ *
+ * Prints the records as the keymap processes them and the HID reports, with
+ * their virtual time, followed by the delays added by the keymap.  The output
+ * is deterministic.  With `--bench`, replays the trace RUNS times instead and
+ * prints the CPU time spent per event and per scan.
+ *
+ * With `--raw-hid`, built with `VENDOR_INSTRUMENTATION_ENABLE`, replays the
+ * trace silently, then answers VIA raw HID packets: each line of the standard
+ * input is a packet in hex, passed to `via_custom_value_command_user`, and
+ * the reply is printed in hex.  See `instrumentation_test.py`.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#    include <x86intrin.h>
+#endif
+
+#include "harness.h"
+
+#ifdef VENDOR_INSTRUMENTATION_ENABLE
+#    include "via.h"
+#endif // VENDOR_INSTRUMENTATION_ENABLE
+
+/** \brief Idle time replayed after the last event, at most, to let pending work finish. */
+#define REPLAY_TAIL_MS 60000
+
+/** \brief Size of a raw HID packet, `RAW_EPSIZE` in QMK. */
+#define REPLAY_RAW_EPSIZE 32
+
+typedef struct {
+    uint32_t time;
+    bool     encoder;
+    uint8_t  row; // Or encoder index.
+    uint8_t  col;
+    bool     pressed; // Or clockwise.
+} replay_event_t;
+
+typedef struct {
+    replay_event_t *events;
+    size_t          count;
+} replay_trace_t;
+
+typedef struct {
+    uint64_t *samples;
+    size_t    count;
+    size_t    capacity;
+} replay_samples_t;
+
+#if defined(__x86_64__) || defined(__i386__)
+#    define REPLAY_CPU_UNIT "cycles"
+static inline uint64_t replay_cpu_time(void) {
+    return __rdtsc();
+}
+#else
+#    define REPLAY_CPU_UNIT "ns"
+static inline uint64_t replay_cpu_time(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+#endif
+
+static void replay_fail(const char *path, unsigned line, const char *message) {
+    fprintf(stderr, "%s:%u: %s\n", path, line, message);
+    exit(2);
+}
+
+/** \brief Parse a trace, with times unwrapped from the 16-bit timer of the board. */
+static replay_trace_t replay_load(const char *path) {
+    replay_trace_t trace    = {0};
+    size_t         capacity = 0;
+    uint32_t       last     = 0;
+    unsigned       number   = 0;
+    char           line[256];
+
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        perror(path);
+        exit(2);
+    }
+    while (fgets(line, sizeof(line), file) != NULL) {
+        ++number;
+        char *text    = strstr(line, "trace: ");
+        text          = text != NULL ? text + strlen("trace: ") : line;
+        char *comment = strchr(text, '#');
+        if (comment != NULL) {
+            *comment = '\0';
+        }
+
+        unsigned       time, a, b;
+        char           kind[8];
+        replay_event_t event = {0};
+        if (sscanf(text, "%u enc %u %7s", &time, &a, kind) == 3) {
+            if (strcmp(kind, "cw") != 0 && strcmp(kind, "ccw") != 0) {
+                replay_fail(path, number, "expected cw or ccw");
+            }
+            event = (replay_event_t){.encoder = true, .row = a, .pressed = strcmp(kind, "cw") == 0};
+        } else if (sscanf(text, "%u %u %u %7s", &time, &a, &b, kind) == 4) {
+            if (a >= MATRIX_ROWS || b >= MATRIX_COLS || (strcmp(kind, "down") != 0 && strcmp(kind, "up") != 0)) {
+                replay_fail(path, number, "expected <row> <col> down|up within the matrix");
+            }
+            event = (replay_event_t){.row = a, .col = b, .pressed = strcmp(kind, "down") == 0};
+        } else if (strspn(text, " \t\r\n") == strlen(text)) {
+            continue;
+        } else {
+            replay_fail(path, number, "expected <time> <row> <col> down|up, or <time> enc <index> cw|ccw");
+        }
+
+        event.time = last + (uint16_t)(time - (uint16_t)last);
+        last       = event.time;
+        if (trace.count == capacity) {
+            capacity     = capacity ? 2 * capacity : 64;
+            trace.events = realloc(trace.events, capacity * sizeof(replay_event_t));
+        }
+        trace.events[trace.count++] = event;
+    }
+    fclose(file);
+    return trace;
+}
+
+static void replay_sample(replay_samples_t *samples, uint64_t value) {
+    if (samples == NULL) {
+        return;
+    }
+    if (samples->count == samples->capacity) {
+        samples->capacity = samples->capacity ? 2 * samples->capacity : 1024;
+        samples->samples  = realloc(samples->samples, samples->capacity * sizeof(uint64_t));
+    }
+    samples->samples[samples->count++] = value;
+}
+
+/** \brief Scan until `time`, idle. */
+static void replay_idle_until(uint32_t time, replay_samples_t *scans) {
+    while (harness_now() < time) {
+        uint64_t start = replay_cpu_time();
+        harness_scan_begin();
+        harness_scan_end();
+        replay_sample(scans, replay_cpu_time() - start);
+    }
+}
+
+/**
+ * \brief Replay the trace once, starting at `start`.
+ *
+ * The events of a millisecond are fed to the same scan.
+ */
+static void replay_run(const replay_trace_t *trace, uint32_t start, replay_samples_t *events, replay_samples_t *scans) {
+    const uint32_t offset = start - trace->events[0].time;
+
+    for (size_t i = 0; i < trace->count;) {
+        const uint32_t time = trace->events[i].time + offset;
+        replay_idle_until(time, scans);
+
+        uint64_t scan_start = replay_cpu_time();
+        harness_scan_begin();
+        for (; i < trace->count && trace->events[i].time + offset == time; ++i) {
+            const replay_event_t *event       = &trace->events[i];
+            uint64_t              event_start = replay_cpu_time();
+            if (event->encoder) {
+                harness_encoder(event->row, event->pressed);
+            } else {
+                harness_key(event->row, event->col, event->pressed);
+            }
+            replay_sample(events, replay_cpu_time() - event_start);
+        }
+        harness_scan_end();
+        replay_sample(scans, replay_cpu_time() - scan_start);
+    }
+    for (uint32_t tail = 0; tail < REPLAY_TAIL_MS && !harness_idle(); ++tail) {
+        replay_idle_until(harness_now() + 1, scans);
+    }
+}
+
+static int replay_compare(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void replay_print_samples(const char *name, replay_samples_t *samples) {
+    if (samples->count == 0) {
+        return;
+    }
+    qsort(samples->samples, samples->count, sizeof(uint64_t), replay_compare);
+    printf("  %-6s p50 %8llu  p99 %8llu  max %8llu " REPLAY_CPU_UNIT "\n", name, (unsigned long long)samples->samples[samples->count / 2], (unsigned long long)samples->samples[samples->count * 99 / 100], (unsigned long long)samples->samples[samples->count - 1]);
+}
+
+static void replay_print_stats(void) {
+    const harness_stats_t *stats = harness_stats();
+
+    printf("# %u presses, %u reports\n", stats->events, stats->reports);
+    if (stats->events) {
+        printf("# press to processed: max %u ms, mean %.1f ms\n", stats->process_delay_max, (double)stats->process_delay_sum / stats->events);
+    }
+    if (stats->report_delay_count) {
+        printf("# press to report:    max %u ms, mean %.1f ms\n", stats->report_delay_max, (double)stats->report_delay_sum / stats->report_delay_count);
+    }
+}
+
+#ifdef VENDOR_INSTRUMENTATION_ENABLE
+/** \brief Answer the raw HID packets of the standard input, one per line in hex, until its end. */
+static int replay_raw_hid(void) {
+    char line[4 * REPLAY_RAW_EPSIZE];
+
+    while (fgets(line, sizeof(line), stdin) != NULL) {
+        uint8_t data[REPLAY_RAW_EPSIZE] = {0};
+        size_t  length                  = 0;
+        for (unsigned byte; length < sizeof(data) && sscanf(&line[2 * length], "%2x", &byte) == 1; ++length) {
+            data[length] = byte;
+        }
+        if (length != sizeof(data)) {
+            fprintf(stderr, "expected a packet of %d bytes in hex\n", REPLAY_RAW_EPSIZE);
+            return 2;
+        }
+        via_custom_value_command_user(data, sizeof(data));
+        for (size_t i = 0; i < sizeof(data); ++i) {
+            printf("%02x", data[i]);
+        }
+        printf("\n");
+        fflush(stdout);
+    }
+    return 0;
+}
+#endif // VENDOR_INSTRUMENTATION_ENABLE
+
+int main(int argc, char **argv) {
+    unsigned long runs = 0;
+#ifdef VENDOR_INSTRUMENTATION_ENABLE
+    bool raw_hid = false;
+#endif // VENDOR_INSTRUMENTATION_ENABLE
+
+    if (argc == 4 && strcmp(argv[1], "--bench") == 0) {
+        runs = strtoul(argv[2], NULL, 10);
+#ifdef VENDOR_INSTRUMENTATION_ENABLE
+    } else if (argc == 3 && strcmp(argv[1], "--raw-hid") == 0) {
+        raw_hid = true;
+#endif // VENDOR_INSTRUMENTATION_ENABLE
+    } else if (argc != 2) {
+        fprintf(stderr, "usage: %s [--bench RUNS | --raw-hid] TRACE\n", argv[0]);
+        return 2;
+    }
+
+    const char    *path  = argv[argc - 1];
+    replay_trace_t trace = replay_load(path);
+    if (trace.count == 0) {
+        fprintf(stderr, "%s: no events\n", path);
+        return 2;
+    }
+
+    harness_init();
+#ifdef VENDOR_INSTRUMENTATION_ENABLE
+    if (raw_hid) {
+        replay_run(&trace, trace.events[0].time, NULL, NULL);
+        return replay_raw_hid();
+    }
+#endif // VENDOR_INSTRUMENTATION_ENABLE
+    if (runs == 0) {
+        harness_log = stdout;
+        replay_run(&trace, trace.events[0].time, NULL, NULL);
+        replay_print_stats();
+        return 0;
+    }
+
+    replay_samples_t events = {0};
+    replay_samples_t scans  = {0};
+    for (unsigned long run = 0; run < runs; ++run) {
+        // Leave a pause between the runs, so that they are independent.
+        replay_run(&trace, harness_now() + 1000, &events, &scans);
+    }
+    printf("%s: %lu runs of %zu events\n", path, runs, trace.count);
+    replay_print_samples("event", &events);
+    replay_print_samples("scan", &scans);
+    return 0;
+}